@@ -0,0 +1,29 @@
+#!/bin/bash
+#Sweeps escort_benchmark over identification threads and synthetic users, prints CSV with time per frame in us.
+#Usage: benchmark_scaling.sh [frames] > scaling.csv
+#Benchmark command can be replaced with ESCORT_BENCHMARK, e.g. to run binary from build directory.
+#Pose is repeated, so that escorted user whose template failed is registered again and identification runs.
+
+FRAMES=${1:-3000}
+THREADS="1 2 4 8"
+USERS="1 2 5 10 20 30 40 50"
+MAX_USERS=50
+POSE_PERIOD=5.0
+ESCORT_BENCHMARK=${ESCORT_BENCHMARK:-"rosrun elektron_escort escort_benchmark"}
+
+Stage() {
+    echo "$1" | sed -n "s/.*Benchmark: $2 \([0-9.]*\) us per frame.*/\1/p"
+}
+
+echo "threads,users,loop_us,tracker_us,identification_us"
+for threads in $THREADS; do
+    for users in $USERS; do
+        output=$($ESCORT_BENCHMARK _benchmarkFrames:=$FRAMES _identificationThreads:=$threads \
+                 _syntheticUsers:=$users _maxUsers:=$MAX_USERS _syntheticPosePeriod:=$POSE_PERIOD 2>&1)
+        if [ $? -ne 0 ]; then
+            echo "Benchmark failed for $threads threads, $users users" >&2
+            exit 1
+        fi
+        echo "$threads,$users,$(Stage "$output" loop),$(Stage "$output" tracker),$(Stage "$output" identification)"
+    done
+done
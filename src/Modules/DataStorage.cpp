@@ -1,4 +1,5 @@
 #include "DataStorage.h"
+#include "TrackerModule.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -42,8 +43,7 @@ bool DataStorage::Initialize(ros::NodeHandle* nodeHandlePrivate) {
         }
         maxUsers = 1;
     }
-    userPose.resize(maxUsers, false);
-    poseCooldown.resize(maxUsers, 0.0);
+    users.Resize(maxUsers);
     XnPoint3D zero;
     zero.X = 0.0f;
     zero.Y = 0.0f;
@@ -61,7 +61,45 @@ bool DataStorage::Initialize(ros::NodeHandle* nodeHandlePrivate) {
         }
         poseCooldownTime = 0.0;
     }
+    if(!nodeHandlePrivate->getParam("comHistoryLength", comHistoryLength)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: Value of comHistoryLength not found, using default: %d", DEFAULT_COM_HISTORY_LENGTH);
+        }
+        comHistoryLength = DEFAULT_COM_HISTORY_LENGTH;
+    }
+    if(comHistoryLength < 2) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: Requested too short center of mass history: %d", comHistoryLength);
+        }
+        comHistoryLength = 2;
+    }
+    if(!nodeHandlePrivate->getParam("predictionHorizon", predictionHorizon)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: Value of predictionHorizon not found, using default: %f", DEFAULT_PREDICTION_HORIZON);
+        }
+        predictionHorizon = DEFAULT_PREDICTION_HORIZON;
+    }
+    if(predictionHorizon < 0.0) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: Requested negative prediction horizon: %f", predictionHorizon);
+        }
+        predictionHorizon = 0.0;
+    }
+    followedUserTrack = UserTrack();
+    currentTimestamp = 0.0;
+    comHistory.resize(maxUsers*comHistoryLength);
+    comHistoryNext.assign(maxUsers, 0);
+    comHistoryCount.assign(maxUsers, 0);
     currentUserXnId = NO_USER;
+    //Pose flags are stamped with tick in which they were raised, tick 0 means never
+    tick = 1;
+    clock = 0.0;
+    publishedVersion = 0;
+    //Slots are sized up front, so publishing copies without allocating
+    DataSnapshot emptySnapshot;
+    emptySnapshot.users.Resize(maxUsers);
+    snapshots.Reset(emptySnapshot);
+    PublishSnapshot(0, 0.0);
     if(logLevel <= Info) {
         ROS_INFO("DataStorage: Initialized");
     }
@@ -69,43 +107,38 @@ bool DataStorage::Initialize(ros::NodeHandle* nodeHandlePrivate) {
 }
 
 void DataStorage::Update(double timeElapsed) {
-    for(int i=0; i<maxUsers; ++i) {
-        if(poseCooldown[i] > 0.0) {
-            poseCooldown[i] -= timeElapsed;
-            if(poseCooldown[i] < 0.0) {
-                poseCooldown[i] = 0.0;
-            }
-        }
-        if(logLevel <= Debug) {
-            ROS_DEBUG("DataStorage: Pose cooldown for %d: %f", i, poseCooldown[i]);
-        }
-        userPose[i] = false;
-    }
+    //Advancing tick clears pose flags of all users, cooldowns are absolute expiry times compared on query,
+    //so nothing has to expire here
+    ++tick;
+    clock += timeElapsed;
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
     if(currentUserXnId != NO_USER) {
-        SensorsModule::GetInstance().GetUserGenerator().GetCoM(currentUserXnId, lastUserPosition);
+        lastUserPosition = GetUserCoM(currentUserXnId);
     }
-    std::set<XnUserID> toRemove;
-    std::set<XnUserID>::iterator iter;
-    for(iter=presentUsers.begin(); iter!=presentUsers.end(); ++iter) {
-        XnPoint3D userCoM;
-        SensorsModule::GetInstance().GetUserGenerator().GetCoM(*iter, userCoM);
+    users.ForEachPresent([&](XnUserID userId) {
+        XnPoint3D userCoM = GetUserCoM(userId);
         if(userCoM.Z <= 1.0) {
-            toRemove.insert(*iter);
+            users.Erase(userId);
             if(logLevel <= Warn) {
-                ROS_WARN("DataStorage: Deleted invalid user: %d", *iter);
+                ROS_WARN("DataStorage: Deleted invalid user: %d", userId);
             }
         }
         else {
-            if(!IsPresentOnScene(*iter)) {
-                if(logLevel <= Warn) {
-                    ROS_WARN("DataStorage: Missing user inserted: %d", *iter);
-                }
+            if(users.Get(userId).lastSeen != frame.timestamp || comHistoryCount[userId-1] == 0) {
+                UpdateCoMHistory(userId, frame.timestamp);
             }
+            users.Get(userId).lastSeen = frame.timestamp;
+        }
+    });
+    currentTimestamp = frame.timestamp;
+    //Followed user keeps own copy of its track, so it survives the tracker dropping it
+    if(currentUserXnId != NO_USER && users.IsPresent(currentUserXnId)) {
+        UserTrack const* track = TrackerModule::GetInstance().GetMotionOfUser(currentUserXnId);
+        if(track != NULL) {
+            followedUserTrack = *track;
         }
     }
-    for(iter=toRemove.begin(); iter!=toRemove.end(); ++iter) {
-        presentUsers.erase(*iter);
-    }
+    PublishSnapshot(frame.frameId, frame.timestamp);
 }
 
 XnUserID DataStorage::GetCurrentUserXnId() {
@@ -117,33 +150,51 @@ void DataStorage::SetCurrentUserXnId(XnUserID newCurrentUserXnId) {
 }
 
 void DataStorage::UserNew(XnUserID userId) {
-    presentUsers.insert(userId);
+    if(!users.IsValid(userId)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: User id above maxUsers ignored: %d", userId);
+        }
+        return;
+    }
+    //New user may reuse id of lost one, so its motion history starts over
+    comHistoryCount[userId-1] = 0;
+    users.Get(userId).velocity.X = 0.0f;
+    users.Get(userId).velocity.Y = 0.0f;
+    users.Get(userId).velocity.Z = 0.0f;
+    users.Insert(userId);
 }
 
 void DataStorage::UserExit(XnUserID userId) {
-    presentUsers.erase(userId);
+    users.Erase(userId);
 }
 
 void DataStorage::UserReEnter(XnUserID userId) {
-    presentUsers.insert(userId);
+    if(!users.IsValid(userId)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DataStorage: User id above maxUsers ignored: %d", userId);
+        }
+        return;
+    }
+    users.Insert(userId);
 }
 
-void DataStorage::UserPose(int userId) {
-    if(userId < 0 || userId >= userPose.size()) {
+void DataStorage::UserPose(XnUserID userId) {
+    if(!users.IsValid(userId)) {
         if(logLevel <= Warn) {
             ROS_WARN("DataStorage: Attempt to change pose detected for invalid user: %d", userId);
         }
         return;
     }
     else {
-        if(poseCooldown[userId] > 0.0) {
+        UserRecord& user = users.Get(userId);
+        if(!IsPoseCooldownPassed(userId)) {
             if(logLevel <= Debug) {
                 ROS_DEBUG("DataStorage: Pose detected for user %d, but ignored due to cooldown", userId);
             }
         }
         else {
-            userPose[userId] = true;
-            poseCooldown[userId] = poseCooldownTime;
+            user.poseTick = tick;
+            user.poseCooldownExpiry = clock + poseCooldownTime;
             if(logLevel <= Debug) {
                 ROS_DEBUG("DataStorage: Pose detected for user %d", userId);
             }
@@ -151,27 +202,27 @@ void DataStorage::UserPose(int userId) {
     }
 }
 
-bool DataStorage::IsUserPose(int userId) {
-    if(userId < 0 || userId >= userPose.size()) {
+bool DataStorage::IsUserPose(XnUserID userId) {
+    if(!users.IsValid(userId)) {
         if(logLevel <= Warn) {
             ROS_WARN("DataStorage: Attempt to read pose detected for invalid user: %d", userId);
         }
         return false;
     }
     else {
-        return userPose[userId];
+        return users.Get(userId).poseTick == tick;
     }
 }
 
-bool DataStorage::IsPoseCooldownPassed(int userId) {
-    if(userId < 0 || userId >= poseCooldown.size()) {
+bool DataStorage::IsPoseCooldownPassed(XnUserID userId) {
+    if(!users.IsValid(userId)) {
         if(logLevel <= Warn) {
             ROS_WARN("DataStorage: Attempt to read pose cooldown for invalid user: %d", userId);
         }
         return true;
     }
     else {
-        if(poseCooldown[userId] <= 0.0) {
+        if(clock >= users.Get(userId).poseCooldownExpiry) {
             return true;
         }
         else {
@@ -181,22 +232,156 @@ bool DataStorage::IsPoseCooldownPassed(int userId) {
 }
 
 bool DataStorage::IsPresentOnScene(XnUserID userId) {
-    if(presentUsers.find(userId) != presentUsers.end()) {
-        return true;
-    }
-    else {
-        return false;
-    }
+    return users.IsPresent(userId);
 }
 
 XnPoint3D DataStorage::GetLastUserPosition() {
     return lastUserPosition;
 }
 
-std::set<XnUserID>* DataStorage::GetPresentUsersSet() {
-    return &presentUsers;
+XnPoint3D DataStorage::GetUserCoM(XnUserID userId) {
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    if(!users.IsValid(userId)) {
+        return frame.GetCoM(userId);
+    }
+    //Cached value is valid only for frame it was read from
+    UserRecord& user = users.Get(userId);
+    if(user.centerOfMassFrameId != frame.frameId) {
+        user.centerOfMass = frame.GetCoM(userId);
+        //NITE may report zero CoM for user whose mask is still there, center of the mask is used instead
+        if(user.centerOfMass.Z <= 1.0) {
+            UserSilhouette const* silhouette = frame.GetSilhouette(userId);
+            if(silhouette != NULL && silhouette->pixels >= SILHOUETTE_MIN_PIXELS && silhouette->meanDepth > 0.0f) {
+                user.centerOfMass = silhouette->center;
+            }
+        }
+        user.centerOfMassFrameId = frame.frameId;
+    }
+    return user.centerOfMass;
+}
+
+XnPoint3D DataStorage::GetUserVelocity(XnUserID userId) {
+    if(!users.IsPresent(userId)) {
+        XnPoint3D zero;
+        zero.X = 0.0f;
+        zero.Y = 0.0f;
+        zero.Z = 0.0f;
+        return zero;
+    }
+    return users.Get(userId).velocity;
+}
+
+int DataStorage::GetUserCoMHistoryCount(XnUserID userId) {
+    if(!users.IsValid(userId)) {
+        return 0;
+    }
+    return comHistoryCount[userId-1];
+}
+
+CoMSample const& DataStorage::GetUserCoMHistory(XnUserID userId, int age) {
+    //Age 0 is the newest sample, caller keeps age below GetUserCoMHistoryCount
+    int index = userId - 1;
+    int slot = (comHistoryNext[index] - 1 - age + 2*comHistoryLength) % comHistoryLength;
+    return comHistory[index*comHistoryLength + slot];
+}
+
+bool DataStorage::IsUserTracked(XnUserID userId) {
+    return users.IsPresent(userId) && TrackerModule::GetInstance().GetMotionOfUser(userId) != NULL;
+}
+
+XnPoint3D DataStorage::GetPredictedPosition(XnUserID userId) {
+    if(!IsUserTracked(userId)) {
+        return GetUserCoM(userId);
+    }
+    return PredictTrack(*TrackerModule::GetInstance().GetMotionOfUser(userId));
+}
+
+bool DataStorage::IsFollowedUserTracked() {
+    return followedUserTrack.initialized;
+}
+
+//Followed user was given up on purpose, so search and coasting must not steer towards the old one
+void DataStorage::ResetFollowedUserTrack() {
+    followedUserTrack = UserTrack();
+}
+
+double DataStorage::GetTimeSinceFollowedUserSeen() {
+    if(!followedUserTrack.initialized) {
+        return 0.0;
+    }
+    return currentTimestamp - followedUserTrack.lastUpdate;
+}
+
+XnPoint3D DataStorage::GetFollowedUserPredictedPosition() {
+    if(!followedUserTrack.initialized) {
+        return lastUserPosition;
+    }
+    return PredictTrack(followedUserTrack);
+}
+
+XnPoint3D DataStorage::GetFollowedUserPredictedVelocity() {
+    XnPoint3D velocity;
+    velocity.X = followedUserTrack.initialized ? followedUserTrack.x.GetVelocity() : 0.0f;
+    velocity.Y = 0.0f;
+    velocity.Z = followedUserTrack.initialized ? followedUserTrack.z.GetVelocity() : 0.0f;
+    return velocity;
+}
+
+UserTable const& DataStorage::GetUserTable() {
+    return users;
 }
 
 int DataStorage::GetMaxUsers() {
     return maxUsers;
+}
+
+DataSnapshot const& DataStorage::GetSnapshot() {
+    return snapshots.Read();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void DataStorage::UpdateCoMHistory(XnUserID userId, double timestamp) {
+    int index = userId - 1;
+    UserRecord& user = users.Get(userId);
+    CoMSample& sample = comHistory[index*comHistoryLength + comHistoryNext[index]];
+    sample.centerOfMass = user.centerOfMass;
+    sample.timestamp = timestamp;
+    comHistoryNext[index] = (comHistoryNext[index] + 1) % comHistoryLength;
+    if(comHistoryCount[index] < comHistoryLength) {
+        ++comHistoryCount[index];
+    }
+    //Velocity over the whole history window, per second of frame time
+    CoMSample const& newest = GetUserCoMHistory(userId, 0);
+    CoMSample const& oldest = GetUserCoMHistory(userId, comHistoryCount[index] - 1);
+    double timeSpan = newest.timestamp - oldest.timestamp;
+    if(timeSpan > 0.0) {
+        user.velocity.X = (newest.centerOfMass.X - oldest.centerOfMass.X)/timeSpan;
+        user.velocity.Y = (newest.centerOfMass.Y - oldest.centerOfMass.Y)/timeSpan;
+        user.velocity.Z = (newest.centerOfMass.Z - oldest.centerOfMass.Z)/timeSpan;
+    }
+}
+
+XnPoint3D DataStorage::PredictTrack(UserTrack const& track) {
+    //Constant velocity is trusted only for limited time after last measurement
+    double timeStep = std::min(std::max(currentTimestamp - track.lastUpdate, 0.0), predictionHorizon);
+    XnPoint3D position;
+    position.X = track.x.PredictPosition(timeStep);
+    position.Y = track.y;
+    position.Z = track.z.PredictPosition(timeStep);
+    return position;
+}
+
+void DataStorage::PublishSnapshot(unsigned long frameId, double timestamp) {
+    //Back slot belongs to this thread only, reader sees it after Publish
+    DataSnapshot& snapshot = snapshots.GetBack();
+    snapshot.version = ++publishedVersion;
+    snapshot.frameId = frameId;
+    snapshot.timestamp = timestamp;
+    snapshot.currentUserXnId = currentUserXnId;
+    snapshot.lastUserPosition = lastUserPosition;
+    snapshot.users = users;
+    snapshots.Publish();
 }
\ No newline at end of file
@@ -4,14 +4,45 @@
 #define DEFAULT_DATA_STORAGE_LOG_LEVEL Info
 #define DEFAULT_MAX_USERS 20
 #define DEFAULT_POSE_COOLDOWN_TIME 3.0
+#define DEFAULT_COM_HISTORY_LENGTH 15
+#define DEFAULT_PREDICTION_HORIZON 2.0
+#define SILHOUETTE_MIN_PIXELS 500
 
 #include <mutex>
+#include <vector>
 #include <ros/ros.h>
 #include <XnCppWrapper.h>
 #include "../Common.h"
 #include "SensorsModule.h"
+#include "UserTable.h"
+#include "../Utilities/ConstantVelocityFilter.h"
+#include "../Utilities/TripleBuffer.h"
 
 
+struct CoMSample {
+    XnPoint3D centerOfMass;
+    double timestamp;
+};
+
+//Ground plane motion of one person, filtered by TrackerModule from center of mass stream
+struct UserTrack {
+    ConstantVelocityFilter x;
+    ConstantVelocityFilter z;
+    double y = 0.0;
+    double lastUpdate = 0.0;
+    bool initialized = false;
+};
+
+//Copy of DataStorage published once per tick, never changed while reader holds it
+struct DataSnapshot {
+    unsigned long version = 0;
+    unsigned long frameId = 0;
+    double timestamp = 0.0;
+    XnUserID currentUserXnId = NO_USER;
+    XnPoint3D lastUserPosition;
+    UserTable users;
+};
+
 class DataStorage {
 public:
     static DataStorage& GetInstance() {
@@ -25,28 +56,53 @@ public:
     void UserNew(XnUserID userId);
     void UserExit(XnUserID userId);
     void UserReEnter(XnUserID userId);
-    void UserPose(int userId);
-    bool IsUserPose(int userId);
-    bool IsPoseCooldownPassed(int userId);
+    void UserPose(XnUserID userId);
+    bool IsUserPose(XnUserID userId);
+    bool IsPoseCooldownPassed(XnUserID userId);
     bool IsPresentOnScene(XnUserID userId);
     XnPoint3D GetLastUserPosition();
-    std::set<XnUserID>* GetPresentUsersSet();
+    XnPoint3D GetUserCoM(XnUserID userId);
+    XnPoint3D GetUserVelocity(XnUserID userId);
+    int GetUserCoMHistoryCount(XnUserID userId);
+    CoMSample const& GetUserCoMHistory(XnUserID userId, int age);
+    bool IsUserTracked(XnUserID userId);
+    XnPoint3D GetPredictedPosition(XnUserID userId);
+    bool IsFollowedUserTracked();
+    void ResetFollowedUserTrack();
+    double GetTimeSinceFollowedUserSeen();
+    XnPoint3D GetFollowedUserPredictedPosition();
+    XnPoint3D GetFollowedUserPredictedVelocity();
+    UserTable const& GetUserTable();
     int GetMaxUsers();
+    //For one reader thread, snapshot stays valid and unchanged until the same thread calls it again
+    DataSnapshot const& GetSnapshot();
 
 private:
     LogLevels logLevel;
     int maxUsers;
     double poseCooldownTime;
+    int comHistoryLength;
+    double predictionHorizon;
     XnUserID currentUserXnId;
-    std::vector<bool> userPose;
-    std::vector<double> poseCooldown;
-    std::set<XnUserID> presentUsers;
+    UserTable users;
     XnPoint3D lastUserPosition;
+    std::vector<CoMSample> comHistory;
+    std::vector<int> comHistoryNext;
+    std::vector<int> comHistoryCount;
+    UserTrack followedUserTrack;
+    double currentTimestamp;
+    unsigned long tick;
+    double clock;
+    unsigned long publishedVersion;
+    TripleBuffer<DataSnapshot> snapshots;
 
     DataStorage() {}
     DataStorage(const DataStorage &);
     DataStorage& operator=(const DataStorage&);
     ~DataStorage() {}
+    void UpdateCoMHistory(XnUserID userId, double timestamp);
+    XnPoint3D PredictTrack(UserTrack const& track);
+    void PublishSnapshot(unsigned long frameId, double timestamp);
 };
 
 #endif //ELEKTRON_ESCORT_DATASTORAGE_H
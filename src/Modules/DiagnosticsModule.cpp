@@ -0,0 +1,229 @@
+#include "DiagnosticsModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool DiagnosticsModule::Initialize(ros::NodeHandle *nodeHandlePublic, ros::NodeHandle *nodeHandlePrivate, double _loopTime) {
+    int _logLevel;
+    if(!nodeHandlePrivate->getParam("diagnosticsModuleLogLevel", _logLevel)) {
+        ROS_WARN("DiagnosticsModule: Log level not found, using default");
+        logLevel = DEFAULT_DIAGNOSTICS_MODULE_LOG_LEVEL;
+    }
+    else {
+        switch (_logLevel) {
+            case 0:
+                logLevel = Debug;
+                break;
+            case 1:
+                logLevel = Info;
+                break;
+            case 2:
+                logLevel = Warn;
+                break;
+            case 3:
+                logLevel = Error;
+                break;
+            default:
+                ROS_WARN("DiagnosticsModule: Requested invalid log level, using default");
+                logLevel = DEFAULT_DIAGNOSTICS_MODULE_LOG_LEVEL;
+                break;
+        }
+    }
+    if(!nodeHandlePrivate->getParam("diagnosticsPublishPeriod", publishPeriod)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DiagnosticsModule: Value of diagnosticsPublishPeriod not found, using default: %f", DEFAULT_DIAGNOSTICS_PUBLISH_PERIOD);
+        }
+        publishPeriod = DEFAULT_DIAGNOSTICS_PUBLISH_PERIOD;
+    }
+    if(!nodeHandlePrivate->getParam("diagnosticsWindow", window)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DiagnosticsModule: Value of diagnosticsWindow not found, using default: %d", DEFAULT_DIAGNOSTICS_WINDOW);
+        }
+        window = DEFAULT_DIAGNOSTICS_WINDOW;
+    }
+    if(window <= 0) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DiagnosticsModule: Requested invalid diagnostics window: %d", window);
+        }
+        window = DEFAULT_DIAGNOSTICS_WINDOW;
+    }
+    if(!nodeHandlePrivate->getParam("traceFile", traceFile)) {
+        if(logLevel <= Info) {
+            ROS_INFO("DiagnosticsModule: Value of traceFile not found, tracing disabled");
+        }
+        traceFile = DEFAULT_TRACE_FILE;
+    }
+    if(!nodeHandlePrivate->getParam("traceBufferSize", traceBufferSize)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DiagnosticsModule: Value of traceBufferSize not found, using default: %d", DEFAULT_TRACE_BUFFER_SIZE);
+        }
+        traceBufferSize = DEFAULT_TRACE_BUFFER_SIZE;
+    }
+    if(traceBufferSize <= 0) {
+        if(logLevel <= Warn) {
+            ROS_WARN("DiagnosticsModule: Requested invalid trace buffer size: %d", traceBufferSize);
+        }
+        traceBufferSize = DEFAULT_TRACE_BUFFER_SIZE;
+    }
+    loopTime = _loopTime;
+    overruns = 0;
+    windowOverruns = 0;
+    lastPublishTime = Now();
+    stages.clear();
+    RegisterStage("loop");
+    RegisterStage("sensors");
+    RegisterStage("tracker");
+    RegisterStage("identification");
+    RegisterStage("task");
+    RegisterStage("mobility");
+    RegisterStage("data_storage");
+    publisher = nodeHandlePublic->advertise<diagnostic_msgs::DiagnosticArray>(DIAGNOSTICS_TOPIC_NAME, 1);
+    if(!traceFile.empty()) {
+        if(!trace.Start(traceFile, traceBufferSize, Now())) {
+            if(logLevel <= Error) {
+                ROS_ERROR("DiagnosticsModule: Could not open trace file: %s", traceFile.c_str());
+            }
+            return false;
+        }
+        if(logLevel <= Info) {
+            ROS_INFO("DiagnosticsModule: Recording trace to: %s", traceFile.c_str());
+        }
+    }
+    if(logLevel <= Info) {
+        ROS_INFO("DiagnosticsModule: Initialized");
+    }
+    return true;
+}
+
+void DiagnosticsModule::Finish() {
+    if(trace.IsRunning()) {
+        trace.Stop();
+        if(logLevel <= Info) {
+            ROS_INFO("DiagnosticsModule: Trace written to: %s, dropped events: %lu", traceFile.c_str(), trace.GetDroppedEventsCount());
+        }
+    }
+    if(logLevel <= Info) {
+        ROS_INFO("DiagnosticsModule: Loop overruns: %lu", overruns);
+        for(int i=0; i < stages.size(); ++i) {
+            LatencyWindow& latency = stages[i].latency;
+            ROS_INFO("DiagnosticsModule: %-32s count: %8lu p50: %8.3f ms p95: %8.3f ms p99: %8.3f ms max: %8.3f ms",
+                     stages[i].name.c_str(), latency.GetTotalCount(), latency.GetPercentile(0.5)*1000.0,
+                     latency.GetPercentile(0.95)*1000.0, latency.GetPercentile(0.99)*1000.0, latency.GetMaxEver()*1000.0);
+        }
+    }
+}
+
+int DiagnosticsModule::RegisterStage(std::string const& name) {
+    stages.push_back(Stage());
+    stages.back().name = name;
+    stages.back().latency.Resize(window);
+    stages.back().start = 0.0;
+    return stages.size() - 1;
+}
+
+void DiagnosticsModule::BeginTick() {
+    BeginStage(DS_Loop);
+}
+
+void DiagnosticsModule::EndTick() {
+    double end = Now();
+    double loopDuration = end - stages[DS_Loop].start;
+    RecordStage(DS_Loop, loopDuration);
+    if(trace.IsRunning()) {
+        trace.Span(stages[DS_Loop].name.c_str(), "stage", stages[DS_Loop].start, end, TT_Control);
+    }
+    if(loopDuration > loopTime) {
+        ++overruns;
+        ++windowOverruns;
+    }
+    if(Now() - lastPublishTime >= publishPeriod) {
+        Publish();
+        lastPublishTime = Now();
+        windowOverruns = 0;
+    }
+}
+
+void DiagnosticsModule::BeginStage(int stage) {
+    stages[stage].start = Now();
+}
+
+void DiagnosticsModule::EndStage(int stage) {
+    double end = Now();
+    stages[stage].latency.Record(end - stages[stage].start);
+    if(trace.IsRunning()) {
+        trace.Span(stages[stage].name.c_str(), "stage", stages[stage].start, end, TT_Control);
+    }
+}
+
+void DiagnosticsModule::RecordStage(int stage, double seconds) {
+    stages[stage].latency.Record(seconds);
+}
+
+bool DiagnosticsModule::IsTracing() {
+    return trace.IsRunning();
+}
+
+void DiagnosticsModule::TraceSpan(const char* name, double start, double end, int threadId) {
+    trace.Span(name, "stage", start, end, threadId);
+}
+
+void DiagnosticsModule::TraceInstant(const char* name, const char* category, long argument) {
+    trace.Instant(name, category, Now(), TT_Control, argument);
+}
+
+void DiagnosticsModule::TraceInstant(const char* name, const char* category, double time, int threadId, long argument) {
+    trace.Instant(name, category, time, threadId, argument);
+}
+
+double DiagnosticsModule::Now() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void DiagnosticsModule::Publish() {
+    diagnostic_msgs::DiagnosticArray message;
+    message.header.stamp = ros::Time::now();
+    for(int i=0; i < stages.size(); ++i) {
+        LatencyWindow& latency = stages[i].latency;
+        diagnostic_msgs::DiagnosticStatus status;
+        status.name = "escort_main: " + stages[i].name;
+        status.hardware_id = "escort_main";
+        status.level = diagnostic_msgs::DiagnosticStatus::OK;
+        status.message = "OK";
+        if(i == DS_Loop && windowOverruns > 0) {
+            status.level = diagnostic_msgs::DiagnosticStatus::WARN;
+            status.message = "Loop overruns";
+        }
+        diagnostic_msgs::KeyValue value;
+        char text[32];
+        const char* keys[] = {"p50 [ms]", "p95 [ms]", "p99 [ms]", "max [ms]"};
+        double values[] = {latency.GetPercentile(0.5), latency.GetPercentile(0.95), latency.GetPercentile(0.99), latency.GetMax()};
+        for(int j=0; j < 4; ++j) {
+            snprintf(text, sizeof(text), "%.3f", values[j]*1000.0);
+            value.key = keys[j];
+            value.value = text;
+            status.values.push_back(value);
+        }
+        value.key = "samples";
+        value.value = std::to_string(latency.GetCount());
+        status.values.push_back(value);
+        if(i == DS_Loop) {
+            value.key = "overruns";
+            value.value = std::to_string(windowOverruns);
+            status.values.push_back(value);
+            value.key = "total overruns";
+            value.value = std::to_string(overruns);
+            status.values.push_back(value);
+        }
+        message.status.push_back(status);
+    }
+    publisher.publish(message);
+    if(logLevel <= Debug) {
+        ROS_DEBUG("DiagnosticsModule: Loop p50: %f ms p99: %f ms overruns: %lu", stages[DS_Loop].latency.GetPercentile(0.5)*1000.0,
+                  stages[DS_Loop].latency.GetPercentile(0.99)*1000.0, windowOverruns);
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef ELEKTRON_ESCORT_DIAGNOSTICS_MODULE_H
+#define ELEKTRON_ESCORT_DIAGNOSTICS_MODULE_H
+
+#define DEFAULT_DIAGNOSTICS_MODULE_LOG_LEVEL Info
+#define DEFAULT_DIAGNOSTICS_PUBLISH_PERIOD 1.0
+#define DEFAULT_DIAGNOSTICS_WINDOW 300
+#define DEFAULT_TRACE_FILE ""
+#define DEFAULT_TRACE_BUFFER_SIZE 65536
+
+#define DIAGNOSTICS_TOPIC_NAME "diagnostics"
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <ros/ros.h>
+#include <ros/package.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+#include "../Common.h"
+#include "../Utilities/LatencyWindow.h"
+#include "../Utilities/TraceRecorder.h"
+
+
+enum DiagnosticsStages {
+    DS_Loop, DS_Sensors, DS_Tracker, DS_Identification, DS_Task, DS_Mobility, DS_DataStorage, DS_NUMBER_OF_STAGES
+};
+
+class DiagnosticsModule {
+public:
+    static DiagnosticsModule &GetInstance() {
+        static DiagnosticsModule instance;
+        return instance;
+    }
+    bool Initialize(ros::NodeHandle *nodeHandlePublic, ros::NodeHandle *nodeHandlePrivate, double loopTime);
+    void Finish();
+    int RegisterStage(std::string const& name);
+    void BeginTick();
+    void EndTick();
+    void BeginStage(int stage);
+    void EndStage(int stage);
+    void RecordStage(int stage, double seconds);
+    bool IsTracing();
+    void TraceSpan(const char* name, double start, double end, int threadId = TT_Control);
+    void TraceInstant(const char* name, const char* category, long argument = -1);
+    void TraceInstant(const char* name, const char* category, double time, int threadId, long argument = -1);
+    static double Now();
+
+private:
+    struct Stage {
+        std::string name;
+        LatencyWindow latency;
+        double start;
+    };
+
+    LogLevels logLevel;
+    ros::Publisher publisher;
+    double publishPeriod;
+    int window;
+    double loopTime;
+    double lastPublishTime;
+    unsigned long overruns;
+    unsigned long windowOverruns;
+    std::vector<Stage> stages;
+    std::string traceFile;
+    int traceBufferSize;
+    TraceRecorder trace;
+
+    DiagnosticsModule() {}
+    DiagnosticsModule(const DiagnosticsModule &);
+    DiagnosticsModule &operator=(const DiagnosticsModule &);
+    ~DiagnosticsModule() {}
+    void Publish();
+};
+
+#endif //ELEKTRON_ESCORT_DIAGNOSTICS_MODULE_H
@@ -0,0 +1,218 @@
+#include "BodyProportion_Method.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void BodyDescriptors::Resize(int users) {
+    means.assign(users*BF_NUMBER_OF_FEATURES, 0.0f);
+    scales.assign(users*BF_NUMBER_OF_FEATURES, 0.0f);
+    counts.assign(users*BF_NUMBER_OF_FEATURES, 0.0f);
+}
+
+void BodyDescriptors::Clear(int user) {
+    std::fill(means.begin() + user*BF_NUMBER_OF_FEATURES, means.begin() + (user + 1)*BF_NUMBER_OF_FEATURES, 0.0f);
+    std::fill(scales.begin() + user*BF_NUMBER_OF_FEATURES, scales.begin() + (user + 1)*BF_NUMBER_OF_FEATURES, 0.0f);
+    std::fill(counts.begin() + user*BF_NUMBER_OF_FEATURES, counts.begin() + (user + 1)*BF_NUMBER_OF_FEATURES, 0.0f);
+}
+
+void BodyDescriptors::Push(int user, float const* __restrict__ sample, float const* __restrict__ valid) {
+    float* __restrict__ mean = &means[user*BF_NUMBER_OF_FEATURES];
+    float* __restrict__ scale = &scales[user*BF_NUMBER_OF_FEATURES];
+    float* __restrict__ count = &counts[user*BF_NUMBER_OF_FEATURES];
+    //Exact mean for first samples, exponential afterwards. Once scale is known residuals are clipped,
+    //so single bad skeleton can not drag the statistics. Branch free, vectorized by the compiler.
+    for(int f=0; f < BF_NUMBER_OF_FEATURES; ++f) {
+        float step = valid[f]*std::max(1.0f/(count[f] + 1.0f), (float)BODY_PROPORTION_SMOOTHING);
+        float limit = count[f] < BODY_PROPORTION_MIN_SAMPLES ? std::numeric_limits<float>::max() :
+                      (float)BODY_PROPORTION_CLIP*std::max(scale[f], (float)BODY_PROPORTION_MIN_SCALE);
+        float residual = std::min(std::max(sample[f] - mean[f], -limit), limit);
+        float spread = count[f] > 0.0f ? std::fabs(residual) : 0.0f;
+        mean[f] += step*residual;
+        scale[f] += step*(spread - scale[f]);
+        count[f] += valid[f];
+    }
+}
+
+const char* BodyProportion_Method::GetName() {
+    return "BodyProportion_Method";
+}
+
+double BodyProportion_Method::GetCost() {
+    return BODY_PROPORTION_METHOD_COST;
+}
+
+void BodyProportion_Method::ClearTemplate() {
+    userDescriptors.Resize(0);
+    templateDescriptor.Resize(0);
+}
+
+void BodyProportion_Method::BeginSaveTemplate() {
+    state = CreatingTemplate;
+    retries = 0;
+    userDescriptors.Resize(DataStorage::GetInstance().GetMaxUsers());
+    templateDescriptor.Resize(1);
+}
+
+void BodyProportion_Method::ContinueSaveTemplate() {
+    if(state != CreatingTemplate) {
+        return;
+    }
+    float sample[BF_NUMBER_OF_FEATURES];
+    float valid[BF_NUMBER_OF_FEATURES];
+    if(CalculateDescriptor(DataStorage::GetInstance().GetCurrentUserXnId(), sample, valid)) {
+        templateDescriptor.Push(0, sample, valid);
+        retries = 0;
+    }
+    else {
+        ++retries;
+        if(retries >= BODY_PROPORTION_RETRIES_LIMIT) {
+            state = NotReady;
+            return;
+        }
+    }
+    if(templateDescriptor.Count(0)[0] >= BODY_PROPORTION_TEMPLATE_SAMPLES) {
+        //Features that vary a lot on template person are trusted less
+        for(int f=0; f < BF_NUMBER_OF_FEATURES; ++f) {
+            float tolerance = BODY_PROPORTION_TOLERANCE + templateDescriptor.Scale(0)[f];
+            templateWeights[f] = 1.0f/(tolerance*tolerance);
+        }
+        state = Ready;
+    }
+}
+
+void BodyProportion_Method::Update() {
+    //Every user only touches own descriptor, so users may be processed in parallel
+    auto updateUsers = [this](int begin, int end) {
+        float sample[BF_NUMBER_OF_FEATURES];
+        float valid[BF_NUMBER_OF_FEATURES];
+        for(XnUserID i=begin; i < end; ++i) {
+            if(DataStorage::GetInstance().IsPresentOnScene(i+1)) {
+                CalculateDescriptor(i+1, sample, valid);
+                userDescriptors.Push(i, sample, valid);
+            }
+            else {
+                userDescriptors.Clear(i);
+            }
+        }
+    };
+    int users = userDescriptors.means.size()/BF_NUMBER_OF_FEATURES;
+    if(threadPool != NULL) {
+        threadPool->ParallelFor(users, BODY_PROPORTION_TASK_USERS, updateUsers);
+    }
+    else {
+        updateUsers(0, users);
+    }
+}
+
+double BodyProportion_Method::RateUser(XnUserID userId) {
+    return RateDescriptor(userId-1);
+}
+
+void BodyProportion_Method::RateUsers(XnUserID const* userIds, int count, float* scores) {
+    for(int i=0; i < count; ++i) {
+        scores[i] = RateDescriptor(userIds[i]-1);
+    }
+}
+
+void BodyProportion_Method::LateUpdate() {
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+double BodyProportion_Method::RateDescriptor(int user) {
+    if(state != Ready) {
+        return 0.0;
+    }
+    //Only features with enough samples take part, at least half of them is required
+    float const* count = userDescriptors.Count(user);
+    float weights[BF_NUMBER_OF_FEATURES];
+    float features = 0.0f;
+    for(int f=0; f < BF_NUMBER_OF_FEATURES; ++f) {
+        float enough = count[f] >= BODY_PROPORTION_MIN_SAMPLES ? 1.0f : 0.0f;
+        weights[f] = enough*templateWeights[f];
+        features += enough;
+    }
+    if(features < BF_NUMBER_OF_FEATURES/2) {
+        return 0.0;
+    }
+    double distance = sqrt(WeightedDistance(userDescriptors.Mean(user), templateDescriptor.Mean(0), weights)/features);
+    if(distance > BODY_PROPORTION_DISTANCE_LIMIT) {
+        return 0.0;
+    }
+    else if(distance >= 1.0) {
+        double x = 1.0 - (distance - 1.0)/(BODY_PROPORTION_DISTANCE_LIMIT - 1.0);
+        return x*x;
+    }
+    return 1.0;
+}
+
+bool BodyProportion_Method::CalculateDescriptor(XnUserID userId, float* sample, float* valid) {
+    struct Bone {
+        XnSkeletonJoint left[2];
+        XnSkeletonJoint right[2];
+    };
+    //Single bones have same left and right side
+    static const Bone bones[BF_NUMBER_OF_FEATURES] = {
+        {{XN_SKEL_LEFT_SHOULDER, XN_SKEL_RIGHT_SHOULDER}, {XN_SKEL_LEFT_SHOULDER, XN_SKEL_RIGHT_SHOULDER}},
+        {{XN_SKEL_LEFT_HIP, XN_SKEL_RIGHT_HIP}, {XN_SKEL_LEFT_HIP, XN_SKEL_RIGHT_HIP}},
+        {{XN_SKEL_HEAD, XN_SKEL_NECK}, {XN_SKEL_HEAD, XN_SKEL_NECK}},
+        {{XN_SKEL_NECK, XN_SKEL_TORSO}, {XN_SKEL_NECK, XN_SKEL_TORSO}},
+        {{XN_SKEL_LEFT_SHOULDER, XN_SKEL_LEFT_ELBOW}, {XN_SKEL_RIGHT_SHOULDER, XN_SKEL_RIGHT_ELBOW}},
+        {{XN_SKEL_LEFT_ELBOW, XN_SKEL_LEFT_HAND}, {XN_SKEL_RIGHT_ELBOW, XN_SKEL_RIGHT_HAND}},
+        {{XN_SKEL_LEFT_HIP, XN_SKEL_LEFT_KNEE}, {XN_SKEL_RIGHT_HIP, XN_SKEL_RIGHT_KNEE}},
+        {{XN_SKEL_LEFT_KNEE, XN_SKEL_LEFT_FOOT}, {XN_SKEL_RIGHT_KNEE, XN_SKEL_RIGHT_FOOT}}
+    };
+    static const XnSkeletonJoint usedJoints[] = {
+        XN_SKEL_HEAD, XN_SKEL_NECK, XN_SKEL_TORSO,
+        XN_SKEL_LEFT_SHOULDER, XN_SKEL_LEFT_ELBOW, XN_SKEL_LEFT_HAND,
+        XN_SKEL_RIGHT_SHOULDER, XN_SKEL_RIGHT_ELBOW, XN_SKEL_RIGHT_HAND,
+        XN_SKEL_LEFT_HIP, XN_SKEL_LEFT_KNEE, XN_SKEL_LEFT_FOOT,
+        XN_SKEL_RIGHT_HIP, XN_SKEL_RIGHT_KNEE, XN_SKEL_RIGHT_FOOT
+    };
+    //Every joint is read from frame once
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    XnSkeletonJointPosition joints[XN_SKEL_RIGHT_FOOT + 1];
+    for(int i=0; i < sizeof(usedJoints)/sizeof(usedJoints[0]); ++i) {
+        joints[usedJoints[i]] = frame.GetJoint(userId, usedJoints[i]);
+    }
+    bool complete = true;
+    for(int f=0; f < BF_NUMBER_OF_FEATURES; ++f) {
+        float length = 0.0f;
+        float sides = 0.0f;
+        for(int side=0; side < 2; ++side) {
+            XnSkeletonJoint const* bone = side == 0 ? bones[f].left : bones[f].right;
+            XnSkeletonJointPosition const& a = joints[bone[0]];
+            XnSkeletonJointPosition const& b = joints[bone[1]];
+            if(std::min(a.fConfidence, b.fConfidence) >= BODY_PROPORTION_MIN_CONFIDENCE) {
+                float x = a.position.X - b.position.X;
+                float y = a.position.Y - b.position.Y;
+                float z = a.position.Z - b.position.Z;
+                length += sqrt(x*x + y*y + z*z);
+                sides += 1.0f;
+            }
+        }
+        if(sides > 0.0f) {
+            sample[f] = length/sides;
+            valid[f] = 1.0f;
+        }
+        else {
+            sample[f] = 0.0f;
+            valid[f] = 0.0f;
+            complete = false;
+        }
+    }
+    return complete;
+}
+
+float BodyProportion_Method::WeightedDistance(float const* __restrict__ a, float const* __restrict__ b, float const* __restrict__ weights) {
+    //Fixed length contiguous loop, vectorized by the compiler
+    float sum = 0.0f;
+    for(int f=0; f < BF_NUMBER_OF_FEATURES; ++f) {
+        float difference = a[f] - b[f];
+        sum += weights[f]*difference*difference;
+    }
+    return sum;
+}
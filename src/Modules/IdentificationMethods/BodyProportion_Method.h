@@ -0,0 +1,65 @@
+#ifndef ELEKTRON_ESCORT_BODY_PROPORTION_METHOD_H
+#define ELEKTRON_ESCORT_BODY_PROPORTION_METHOD_H
+
+#define BODY_PROPORTION_TEMPLATE_SAMPLES 30
+#define BODY_PROPORTION_MIN_SAMPLES 15
+#define BODY_PROPORTION_RETRIES_LIMIT 60
+#define BODY_PROPORTION_MIN_CONFIDENCE 0.5
+#define BODY_PROPORTION_SMOOTHING 0.05
+#define BODY_PROPORTION_CLIP 2.5
+#define BODY_PROPORTION_MIN_SCALE 10.0
+#define BODY_PROPORTION_TOLERANCE 15.0
+#define BODY_PROPORTION_DISTANCE_LIMIT 4.0
+#define BODY_PROPORTION_METHOD_COST 1.0
+#define BODY_PROPORTION_TASK_USERS 4
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include "Identification_Method.h"
+#include "../SensorsModule.h"
+
+
+//Bone lengths in mm, paired bones are averaged over confident sides
+enum BodyFeatures {
+    BF_ShoulderWidth, BF_HipWidth, BF_Neck, BF_Torso, BF_UpperArm, BF_Forearm, BF_Thigh, BF_Shin, BF_NUMBER_OF_FEATURES
+};
+
+//Running robust mean and scale of every feature, one row of BF_NUMBER_OF_FEATURES floats per user
+struct BodyDescriptors {
+    std::vector<float> means;
+    std::vector<float> scales;
+    std::vector<float> counts;
+
+    void Resize(int users);
+    void Clear(int user);
+    float const* Mean(int user) const { return &means[user*BF_NUMBER_OF_FEATURES]; }
+    float const* Scale(int user) const { return &scales[user*BF_NUMBER_OF_FEATURES]; }
+    float const* Count(int user) const { return &counts[user*BF_NUMBER_OF_FEATURES]; }
+    void Push(int user, float const* sample, float const* valid);
+};
+
+class BodyProportion_Method final : public Identification_Method {
+public:
+    const char* GetName();
+    double GetCost();
+    void ClearTemplate();
+    void BeginSaveTemplate();
+    void ContinueSaveTemplate();
+    void Update();
+    double RateUser(XnUserID userId);
+    void RateUsers(XnUserID const* userIds, int count, float* scores);
+    void LateUpdate();
+
+private:
+    BodyDescriptors userDescriptors;
+    BodyDescriptors templateDescriptor;
+    float templateWeights[BF_NUMBER_OF_FEATURES];
+    int retries = 0;
+    double RateDescriptor(int user);
+    static bool CalculateDescriptor(XnUserID userId, float* sample, float* valid);
+    static float WeightedDistance(float const* a, float const* b, float const* weights);
+};
+
+#endif //ELEKTRON_ESCORT_BODY_PROPORTION_METHOD_H
@@ -0,0 +1,155 @@
+#include "ColorAppearance_Method.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+const char* ColorAppearance_Method::GetName() {
+    return "ColorAppearance_Method";
+}
+
+double ColorAppearance_Method::GetCost() {
+    return COLOR_APPEARANCE_METHOD_COST;
+}
+
+void ColorAppearance_Method::ClearTemplate() {
+    userAppearances.clear();
+    userSamples.clear();
+}
+
+void ColorAppearance_Method::BeginSaveTemplate() {
+    retries = 0;
+    int maxUsers = DataStorage::GetInstance().GetMaxUsers();
+    userAppearances.assign(maxUsers*appearanceSize, 0.0f);
+    userSamples.assign(maxUsers*COLOR_HISTOGRAM_REGIONS, 0);
+    std::fill(templateAppearance, templateAppearance + appearanceSize, 0.0f);
+    std::fill(templateSamples, templateSamples + COLOR_HISTOGRAM_REGIONS, 0);
+    state = SensorsModule::GetInstance().IsColorEnabled() ? CreatingTemplate : Ready;
+}
+
+void ColorAppearance_Method::ContinueSaveTemplate() {
+    if(state != CreatingTemplate) {
+        return;
+    }
+    if(PushAppearance(DataStorage::GetInstance().GetCurrentUserXnId(), templateAppearance, templateSamples)) {
+        retries = 0;
+    }
+    else {
+        ++retries;
+        if(retries >= COLOR_APPEARANCE_RETRIES_LIMIT) {
+            state = NotReady;
+            return;
+        }
+    }
+    if(templateSamples[CR_Upper] >= COLOR_APPEARANCE_TEMPLATE_SAMPLES) {
+        state = Ready;
+    }
+}
+
+void ColorAppearance_Method::Update() {
+    if(!SensorsModule::GetInstance().IsColorEnabled()) {
+        return;
+    }
+    //Every user only touches own appearance, so users may be processed in parallel
+    auto updateUsers = [this](int begin, int end) {
+        for(XnUserID i=begin; i < end; ++i) {
+            float* appearance = &userAppearances[i*appearanceSize];
+            int* samples = &userSamples[i*COLOR_HISTOGRAM_REGIONS];
+            if(DataStorage::GetInstance().IsPresentOnScene(i+1)) {
+                PushAppearance(i+1, appearance, samples);
+            }
+            else {
+                std::fill(appearance, appearance + appearanceSize, 0.0f);
+                std::fill(samples, samples + COLOR_HISTOGRAM_REGIONS, 0);
+            }
+        }
+    };
+    int users = userSamples.size()/COLOR_HISTOGRAM_REGIONS;
+    if(threadPool != NULL) {
+        threadPool->ParallelFor(users, COLOR_APPEARANCE_TASK_USERS, updateUsers);
+    }
+    else {
+        updateUsers(0, users);
+    }
+}
+
+double ColorAppearance_Method::RateUser(XnUserID userId) {
+    return RateAppearance(userId-1);
+}
+
+void ColorAppearance_Method::RateUsers(XnUserID const* userIds, int count, float* scores) {
+    for(int i=0; i < count; ++i) {
+        scores[i] = RateAppearance(userIds[i]-1);
+    }
+}
+
+void ColorAppearance_Method::LateUpdate() {
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ColorAppearance_Method::PushAppearance(XnUserID userId, float* appearance, int* samples) {
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    bool pushed = false;
+    for(int region=0; region < COLOR_HISTOGRAM_REGIONS; ++region) {
+        float const* __restrict__ histogram = frame.GetColorHistogram(userId, (ColorRegions)region);
+        //Regions without any pixel, e.g. legs hidden behind obstacle, keep their previous appearance
+        if(histogram == NULL || std::accumulate(histogram, histogram + COLOR_HISTOGRAM_BINS, 0.0f) <= 0.0f) {
+            continue;
+        }
+        float* __restrict__ mean = appearance + region*COLOR_HISTOGRAM_BINS;
+        float step = std::max(1.0f/(samples[region] + 1), (float)COLOR_APPEARANCE_SMOOTHING);
+        for(int bin=0; bin < COLOR_HISTOGRAM_BINS; ++bin) {
+            mean[bin] += step*(std::sqrt(histogram[bin]) - mean[bin]);
+        }
+        ++samples[region];
+        pushed = true;
+    }
+    return pushed;
+}
+
+double ColorAppearance_Method::RateAppearance(int user) {
+    if(state != Ready || userAppearances.empty()) {
+        return 0.0;
+    }
+    //Regions seen on both template and candidate are averaged
+    float const* appearance = &userAppearances[user*appearanceSize];
+    int const* samples = &userSamples[user*COLOR_HISTOGRAM_REGIONS];
+    double similarity = 0.0;
+    int regions = 0;
+    for(int region=0; region < COLOR_HISTOGRAM_REGIONS; ++region) {
+        if(samples[region] < COLOR_APPEARANCE_MIN_SAMPLES || templateSamples[region] < COLOR_APPEARANCE_MIN_SAMPLES) {
+            continue;
+        }
+        float const* a = appearance + region*COLOR_HISTOGRAM_BINS;
+        float const* b = templateAppearance + region*COLOR_HISTOGRAM_BINS;
+        double norm = sqrt(Dot(a, a)*Dot(b, b));
+        if(norm > 0.0) {
+            similarity += Dot(a, b)/norm;
+            ++regions;
+        }
+    }
+    if(regions == 0) {
+        return 0.0;
+    }
+    similarity /= regions;
+    if(similarity <= COLOR_APPEARANCE_MISMATCH) {
+        return 0.0;
+    }
+    else if(similarity < COLOR_APPEARANCE_MATCH) {
+        double x = (similarity - COLOR_APPEARANCE_MISMATCH)/(COLOR_APPEARANCE_MATCH - COLOR_APPEARANCE_MISMATCH);
+        return x*x;
+    }
+    return 1.0;
+}
+
+float ColorAppearance_Method::Dot(float const* __restrict__ a, float const* __restrict__ b) {
+    //Fixed length contiguous loop, vectorized by the compiler
+    float sum = 0.0f;
+    for(int bin=0; bin < COLOR_HISTOGRAM_BINS; ++bin) {
+        sum += a[bin]*b[bin];
+    }
+    return sum;
+}
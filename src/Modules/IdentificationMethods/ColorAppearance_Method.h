@@ -0,0 +1,48 @@
+#ifndef ELEKTRON_ESCORT_COLOR_APPEARANCE_METHOD_H
+#define ELEKTRON_ESCORT_COLOR_APPEARANCE_METHOD_H
+
+#define COLOR_APPEARANCE_TEMPLATE_SAMPLES 30
+#define COLOR_APPEARANCE_MIN_SAMPLES 10
+#define COLOR_APPEARANCE_RETRIES_LIMIT 60
+#define COLOR_APPEARANCE_SMOOTHING 0.1
+#define COLOR_APPEARANCE_MATCH 0.9
+#define COLOR_APPEARANCE_MISMATCH 0.5
+#define COLOR_APPEARANCE_METHOD_COST 2.0
+#define COLOR_APPEARANCE_TASK_USERS 4
+
+#include <cmath>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include "Identification_Method.h"
+#include "../SensorsModule.h"
+
+
+//Compares clothing colors of upper and lower body. Appearance of every region is running mean of
+//square roots of its color histograms, so their normalized dot product approximates Bhattacharyya coefficient.
+//Without color capture method is ready at once and rates every user with 0.
+class ColorAppearance_Method final : public Identification_Method {
+public:
+    const char* GetName();
+    double GetCost();
+    void ClearTemplate();
+    void BeginSaveTemplate();
+    void ContinueSaveTemplate();
+    void Update();
+    double RateUser(XnUserID userId);
+    void RateUsers(XnUserID const* userIds, int count, float* scores);
+    void LateUpdate();
+
+private:
+    static const int appearanceSize = COLOR_HISTOGRAM_REGIONS*COLOR_HISTOGRAM_BINS;
+    std::vector<float> userAppearances;
+    std::vector<int> userSamples;
+    float templateAppearance[appearanceSize];
+    int templateSamples[COLOR_HISTOGRAM_REGIONS];
+    int retries = 0;
+    bool PushAppearance(XnUserID userId, float* appearance, int* samples);
+    double RateAppearance(int user);
+    static float Dot(float const* a, float const* b);
+};
+
+#endif //ELEKTRON_ESCORT_COLOR_APPEARANCE_METHOD_H
@@ -4,6 +4,14 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Public
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+const char* Height_Method::GetName() {
+    return "Height_Method";
+}
+
+double Height_Method::GetCost() {
+    return HEIGHT_METHOD_COST;
+}
+
 void Height_Method::ClearTemplate() {
     originalHeight = 0.0;
     userHeightSamples.clear();
@@ -14,17 +22,25 @@ void Height_Method::BeginSaveTemplate() {
     originalHeight = 0.0;
     state = CreatingTemplate;
     retries = 0;
+    //Scene analyzer may not find floor at all, then joint chain is used for the whole template
+    floorBased = SensorsModule::GetInstance().IsFloorEnabled() && SensorsModule::GetInstance().GetFrame().floorAvailable;
+    templateSamples = floorBased ? FLOOR_NUMBER_OF_TEMPLATE_SAMPLES : DEFAULT_NUMBER_OF_TEMPLATE_SAMPLES;
+    minSamples = floorBased ? FLOOR_MIN_NUMBER_OF_SAMPLES : MIN_NUMBER_OF_SAMPLES;
     userHeightSamples.resize(DataStorage::GetInstance().GetMaxUsers());
+    for(int i=0; i < userHeightSamples.size(); ++i) {
+        userHeightSamples[i].Resize(MAX_NUMBER_OF_SAMPLES);
+    }
 }
 
 void Height_Method::ContinueSaveTemplate() {
     if(state != CreatingTemplate) {
         return;
     }
-    if(numberOfCollectedsamples < DEFAULT_NUMBER_OF_TEMPLATE_SAMPLES) {
+    if(numberOfCollectedsamples < templateSamples) {
         double confidence;
-        double heightSample = CalculateHeight(DataStorage::GetInstance().GetCurrentUserXnId(), confidence);
-        if(confidence >= 1.0) {
+        double heightSample = MeasureHeight(DataStorage::GetInstance().GetCurrentUserXnId(), confidence);
+        //Floor measurement is valid for any head it accepts, joint chain needs every joint confident
+        if(confidence >= (floorBased ? HEAD_MIN_CONFIDENCE : 1.0)) {
             originalHeight += heightSample;
             ++numberOfCollectedsamples;
             retries = 0;
@@ -36,35 +52,64 @@ void Height_Method::ContinueSaveTemplate() {
             }
         }
     }
-    else if(numberOfCollectedsamples >= DEFAULT_NUMBER_OF_TEMPLATE_SAMPLES) {
+    else if(numberOfCollectedsamples >= templateSamples) {
         originalHeight = originalHeight/numberOfCollectedsamples;
         state = Ready;
     }
 }
 
 void Height_Method::Update() {
-    for(XnUserID i=0; i < userHeightSamples.size(); ++i) {
-        if(DataStorage::GetInstance().IsPresentOnScene(i+1)) {
-            userHeightSamples[i].push_front(CalculateHeight(i+1));
-            if(userHeightSamples[i].size() > MAX_NUMBER_OF_SAMPLES) {
-                userHeightSamples[i].pop_back();
+    //Every user only touches own samples, so users may be processed in parallel
+    auto updateUsers = [this](int begin, int end) {
+        for(XnUserID i=begin; i < end; ++i) {
+            if(DataStorage::GetInstance().IsPresentOnScene(i+1)) {
+                double confidence;
+                double heightSample = MeasureHeight(i+1, confidence);
+                //Joint chain is always sampled, floor measurement only when there is head or mask to measure
+                if(!floorBased || confidence > 0.0) {
+                    userHeightSamples[i].Push(heightSample);
+                }
+            }
+            else {
+                userHeightSamples[i].Clear();
             }
         }
-        else {
-            userHeightSamples[i].clear();
-        }
+    };
+    if(threadPool != NULL) {
+        threadPool->ParallelFor(userHeightSamples.size(), HEIGHT_METHOD_TASK_USERS, updateUsers);
+    }
+    else {
+        updateUsers(0, userHeightSamples.size());
     }
-
 }
 
 double Height_Method::RateUser(XnUserID userId) {
-    if(userHeightSamples[userId-1].size() >= MIN_NUMBER_OF_SAMPLES) {
-        double userHeight = 0.0;
-        for (std::list<double>::iterator iter = userHeightSamples[userId - 1].begin();
-             iter != userHeightSamples[userId - 1].end(); ++iter) {
-            userHeight += *iter;
-        }
-        userHeight = userHeight / userHeightSamples[userId - 1].size();
+    return RateHeight(userHeightSamples[userId-1]);
+}
+
+void Height_Method::RateUsers(XnUserID const* userIds, int count, float* scores) {
+    for(int i=0; i < count; ++i) {
+        scores[i] = RateHeight(userHeightSamples[userIds[i]-1]);
+    }
+}
+
+void Height_Method::LateUpdate() {
+}
+
+double Height_Method::GetUserHeightDeviation(XnUserID userId) {
+    if(userId < 1 || userId > userHeightSamples.size()) {
+        return 0.0;
+    }
+    return userHeightSamples[userId-1].GetStandardDeviation();
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+double Height_Method::RateHeight(RollingStatistics const& heightSamples) {
+    if(heightSamples.GetCount() >= minSamples) {
+        double userHeight = heightSamples.GetMean();
         double difference = abs(userHeight - originalHeight);
         if (difference > DEFAULT_HEIGHT_LIMIT) {
             return 0.0;
@@ -82,13 +127,33 @@ double Height_Method::RateUser(XnUserID userId) {
     }
 }
 
-void Height_Method::LateUpdate() {
+double Height_Method::MeasureHeight(XnUserID userId, double &confidence) {
+    if(floorBased) {
+        return CalculateFloorHeight(userId, confidence);
+    }
+    return CalculateHeight(userId, confidence);
 }
 
+double Height_Method::CalculateFloorHeight(XnUserID userId, double &confidence) {
+    confidence = 0.0;
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    if(!frame.floorAvailable) {
+        return 0.0;
+    }
+    XnSkeletonJointPosition head = frame.GetJoint(userId, XN_SKEL_HEAD);
+    if(head.fConfidence >= HEAD_MIN_CONFIDENCE) {
+        confidence = head.fConfidence;
+        return frame.GetHeightAboveFloor(head.position) + HEAD_CROWN_OFFSET;
+    }
+    //Mask is there before calibration and under partial occlusion, its top is the crown
+    UserSilhouette const* silhouette = frame.GetSilhouette(userId);
+    if(silhouette != NULL && silhouette->pixels >= SILHOUETTE_MIN_PIXELS && silhouette->meanDepth > 0.0f) {
+        confidence = 1.0;
+        return frame.GetHeightAboveFloor(silhouette->crown);
+    }
+    return 0.0;
+}
 
-///////////////////////////////////////////////////////////////////////////////////////////////////////////
-//Private
-///////////////////////////////////////////////////////////////////////////////////////////////////////////
 double Height_Method::CalculateHeight(XnUserID const& userId) {
     double confidence;
     return CalculateHeight(userId, confidence);
@@ -135,10 +200,9 @@ double Height_Method::CalculateHeight(XnUserID const& userId, double &confidence
 
 double Height_Method::CalculateJointDistance(XnUserID const& userId, XnSkeletonJoint const& jointA, XnSkeletonJoint const& jointB, double &confidence)
 {
-    XnSkeletonJointPosition joint_A_Postition;
-    XnSkeletonJointPosition joint_B_Postition;
-    SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().GetSkeletonJointPosition(userId, jointA, joint_A_Postition);
-    SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().GetSkeletonJointPosition(userId, jointB, joint_B_Postition);
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    XnSkeletonJointPosition joint_A_Postition = frame.GetJoint(userId, jointA);
+    XnSkeletonJointPosition joint_B_Postition = frame.GetJoint(userId, jointB);
     double xDistance = abs(joint_A_Postition.position.X - joint_B_Postition.position.X);
     double yDistance = abs(joint_A_Postition.position.Y - joint_B_Postition.position.Y);
     double zDistance = abs(joint_A_Postition.position.Z - joint_B_Postition.position.Z);
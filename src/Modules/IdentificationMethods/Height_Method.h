@@ -7,26 +7,46 @@
 #define DEFAULT_HEIGHT_TOLERANCE 20.0
 #define DEFAULT_HEIGHT_LIMIT 250.0
 #define DEFAULT_RETRIES_LIMIT 60
+#define FLOOR_NUMBER_OF_TEMPLATE_SAMPLES 15
+#define FLOOR_MIN_NUMBER_OF_SAMPLES 10
+#define HEAD_CROWN_OFFSET 120.0
+#define HEAD_MIN_CONFIDENCE 0.5
+#define HEIGHT_METHOD_COST 1.0
+#define HEIGHT_METHOD_TASK_USERS 4
 
 #include <algorithm>
 #include "Identification_Method.h"
 #include "../SensorsModule.h"
+#include "../../Utilities/RollingStatistics.h"
 
 
-class Height_Method : public Identification_Method {
+//Height of every user is averaged over recent frames. With floor plane known, height is distance of the crown
+//from floor, taken from head joint or from top of user mask when skeleton is not tracked. Otherwise it is
+//sum of joint distances from head to foot. Estimator is chosen when saving template, so samples never mix.
+class Height_Method final : public Identification_Method {
 public:
+    const char* GetName();
+    double GetCost();
     void ClearTemplate();
     void BeginSaveTemplate();
     void ContinueSaveTemplate();
     void Update();
     double RateUser(XnUserID userId);
+    void RateUsers(XnUserID const* userIds, int count, float* scores);
     void LateUpdate();
+    double GetUserHeightDeviation(XnUserID userId);
 
 private:
-    std::vector<std::list<double>> userHeightSamples;
+    std::vector<RollingStatistics> userHeightSamples;
     int numberOfCollectedsamples = 0;
     int retries = 0;
     double originalHeight = 0.0;
+    bool floorBased = false;
+    int templateSamples = DEFAULT_NUMBER_OF_TEMPLATE_SAMPLES;
+    int minSamples = MIN_NUMBER_OF_SAMPLES;
+    double MeasureHeight(XnUserID userId, double &confidence);
+    double CalculateFloorHeight(XnUserID userId, double &confidence);
+    double RateHeight(RollingStatistics const& heightSamples);
     double CalculateHeight(XnUserID const& userId);
     double CalculateHeight(XnUserID const& userId, double &confidence);
     double CalculateJointDistance(XnUserID const& userId, XnSkeletonJoint const& jointA, XnSkeletonJoint const& jointB, double &confidence);
@@ -1,5 +1,9 @@
 #include "Identification_Method.h"
 
+double Identification_Method::GetCost() {
+    return 1.0;
+}
+
 MethodState Identification_Method::GetState() {
     return state;
 }
@@ -10,4 +14,21 @@ double Identification_Method::GetTrustValue() {
 
 void Identification_Method::SetTrustValue(double newTrustValue) {
     trustValue = newTrustValue;
-}
\ No newline at end of file
+}
+
+void Identification_Method::SetThreadPool(ThreadPool* pool) {
+    threadPool = pool;
+}
+
+void Identification_Method::RateUsers(XnUserID const* userIds, int count, float* scores) {
+    for(int i=0; i < count; ++i) {
+        scores[i] = RateUser(userIds[i]);
+    }
+}
+
+void Identification_Method::AccumulateWeighted(float const* __restrict__ scores, float weight, int count, float* __restrict__ ranking) {
+    //Plain contiguous loop, vectorized by the compiler
+    for(int i=0; i < count; ++i) {
+        ranking[i] += scores[i]*weight;
+    }
+}
@@ -4,6 +4,7 @@
 #include <XnCppWrapper.h>
 #include "../../Common.h"
 #include "../DataStorage.h"
+#include "../../Utilities/ThreadPool.h"
 
 
 enum MethodState {
@@ -12,19 +13,26 @@ enum MethodState {
 
 class Identification_Method {
 public:
+    virtual const char* GetName()=0;
+    virtual double GetCost();
     virtual void ClearTemplate()=0;
     virtual void BeginSaveTemplate()=0;
     virtual void ContinueSaveTemplate()=0;
     virtual void Update()=0;
     virtual double RateUser(XnUserID userId)=0;
+    virtual void RateUsers(XnUserID const* userIds, int count, float* scores);
     virtual void LateUpdate()=0;
     MethodState GetState();
     double GetTrustValue();
     void SetTrustValue(double newTrustValue);
+    void SetThreadPool(ThreadPool* pool);
+    static void AccumulateWeighted(float const* scores, float weight, int count, float* ranking);
 
 protected:
     double trustValue = 0.0;
     MethodState state = NotReady;
+    //Optional, per user work may be split on it when set
+    ThreadPool* threadPool = NULL;
 };
 
 #endif //ELEKTRON_ESCORT_IDENTIFICATIONMETHOD_H
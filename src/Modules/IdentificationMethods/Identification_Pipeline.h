@@ -0,0 +1,80 @@
+#ifndef ELEKTRON_ESCORT_IDENTIFICATION_PIPELINE_H
+#define ELEKTRON_ESCORT_IDENTIFICATION_PIPELINE_H
+
+#include <tuple>
+#include "Identification_Method.h"
+
+
+//Owns one instance of every method type. Besides indexed access through the common base,
+//methods can be run as a compile-time sequence: calls are qualified with the concrete type,
+//so they are bound statically and each method scores the whole candidate batch at once.
+template<typename... Methods>
+class Identification_Pipeline {
+public:
+    static const int size = sizeof...(Methods);
+
+    Identification_Method* Get(int index) {
+        Identification_Method* result = NULL;
+        Step<0, size>::Get(methods, index, result);
+        return result;
+    }
+
+    void Update() {
+        Step<0, size>::Update(methods);
+    }
+
+    //Rates candidates with method of given index. Method is still picked at runtime, by comparison chain
+    //over indices once per batch, only call to its RateUsers is bound statically to concrete type
+    void RateUsersAt(int index, XnUserID const* userIds, int count, float* scores) {
+        Step<0, size>::RateUsersAt(methods, index, userIds, count, scores);
+    }
+
+    void LateUpdate() {
+        Step<0, size>::LateUpdate(methods);
+    }
+
+private:
+    typedef std::tuple<Methods...> MethodsTuple;
+    MethodsTuple methods;
+
+    template<int I, int N>
+    struct Step {
+        typedef typename std::tuple_element<I, MethodsTuple>::type Method;
+
+        static void Get(MethodsTuple& methods, int index, Identification_Method*& result) {
+            if(index == I) {
+                result = &std::get<I>(methods);
+                return;
+            }
+            Step<I + 1, N>::Get(methods, index, result);
+        }
+
+        static void Update(MethodsTuple& methods) {
+            std::get<I>(methods).Method::Update();
+            Step<I + 1, N>::Update(methods);
+        }
+
+        static void RateUsersAt(MethodsTuple& methods, int index, XnUserID const* userIds, int count, float* scores) {
+            if(index == I) {
+                std::get<I>(methods).Method::RateUsers(userIds, count, scores);
+                return;
+            }
+            Step<I + 1, N>::RateUsersAt(methods, index, userIds, count, scores);
+        }
+
+        static void LateUpdate(MethodsTuple& methods) {
+            std::get<I>(methods).Method::LateUpdate();
+            Step<I + 1, N>::LateUpdate(methods);
+        }
+    };
+
+    template<int N>
+    struct Step<N, N> {
+        static void Get(MethodsTuple& methods, int index, Identification_Method*& result) {}
+        static void Update(MethodsTuple& methods) {}
+        static void RateUsersAt(MethodsTuple& methods, int index, XnUserID const* userIds, int count, float* scores) {}
+        static void LateUpdate(MethodsTuple& methods) {}
+    };
+};
+
+#endif //ELEKTRON_ESCORT_IDENTIFICATION_PIPELINE_H
@@ -4,13 +4,21 @@
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Public
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
+const char* UserID_Method::GetName() {
+    return "UserID_Method";
+}
+
+double UserID_Method::GetCost() {
+    return USER_ID_METHOD_COST;
+}
+
 void UserID_Method::ClearTemplate() {
-    originalId = NO_USER;
+    originalTrack = NO_TRACK;
 }
 
 void UserID_Method::BeginSaveTemplate() {
     if(DataStorage::GetInstance().GetCurrentUserXnId() != NO_USER) {
-        originalId = DataStorage::GetInstance().GetCurrentUserXnId();
+        originalTrack = TrackerModule::GetInstance().GetTrackId(DataStorage::GetInstance().GetCurrentUserXnId());
         state = Ready;
         repeats = REPEATS_LIMIT;
     }
@@ -27,9 +35,10 @@ void UserID_Method::Update() {
 }
 
 double UserID_Method::RateUser(XnUserID userId) {
-    if(originalId != NO_USER) {
-        if(originalId == userId) {
-            return (repeats/REPEATS_LIMIT);
+    //Persistent track follows the person when NITE swaps or reissues ids
+    if(originalTrack != NO_TRACK) {
+        if(originalTrack == TrackerModule::GetInstance().GetTrackId(userId)) {
+            return ((double)repeats/REPEATS_LIMIT);
         }
     }
     return 0.0;
@@ -37,14 +46,15 @@ double UserID_Method::RateUser(XnUserID userId) {
 
 void UserID_Method::LateUpdate() {
     if(DataStorage::GetInstance().GetCurrentUserXnId() != NO_USER) {
-        if(originalId == DataStorage::GetInstance().GetCurrentUserXnId())
+        unsigned long currentTrack = TrackerModule::GetInstance().GetTrackId(DataStorage::GetInstance().GetCurrentUserXnId());
+        if(originalTrack == currentTrack)
         {
             if(repeats < REPEATS_LIMIT) {
                 repeats++;
             }
         }
         else {
-            originalId = DataStorage::GetInstance().GetCurrentUserXnId();
+            originalTrack = currentTrack;
             repeats = 0;
         }
 
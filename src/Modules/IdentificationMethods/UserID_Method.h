@@ -2,12 +2,16 @@
 #define ELEKTRON_ESCORT_USERID_METHOD_H
 
 #define REPEATS_LIMIT 60
+#define USER_ID_METHOD_COST 0.1
 
 #include "Identification_Method.h"
+#include "../TrackerModule.h"
 
 
-class UserID_Method: public Identification_Method {
+class UserID_Method final : public Identification_Method {
 public:
+    const char* GetName();
+    double GetCost();
     void ClearTemplate();
     void BeginSaveTemplate();
     void ContinueSaveTemplate();
@@ -16,7 +20,7 @@ public:
     void LateUpdate();
 
 private:
-    XnUserID originalId;
+    unsigned long originalTrack = NO_TRACK;
     int repeats = 0;
 };
 
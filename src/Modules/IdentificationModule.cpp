@@ -36,8 +36,55 @@ bool IdentificationModule::Initialize(ros::NodeHandle *nodeHandlePrivate) {
         }
         identificationThreshold = DEFAULT_IDENTIFICATION_THRESHOLD;
     }
+    if(!nodeHandlePrivate->getParam("identificationEvidenceGain", evidenceGain)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Value of identificationEvidenceGain not found, using default: %f", DEFAULT_IDENTIFICATION_EVIDENCE_GAIN);
+        }
+        evidenceGain = DEFAULT_IDENTIFICATION_EVIDENCE_GAIN;
+    }
+    if(!nodeHandlePrivate->getParam("identificationMaxLogOdds", maxLogOdds)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Value of identificationMaxLogOdds not found, using default: %f", DEFAULT_IDENTIFICATION_MAX_LOG_ODDS);
+        }
+        maxLogOdds = DEFAULT_IDENTIFICATION_MAX_LOG_ODDS;
+    }
+    if(!ReadProbability(nodeHandlePrivate, "identificationAcquireProbability", DEFAULT_IDENTIFICATION_ACQUIRE_PROBABILITY, acquireLogOdds) ||
+            !ReadProbability(nodeHandlePrivate, "identificationReleaseProbability", DEFAULT_IDENTIFICATION_RELEASE_PROBABILITY, releaseLogOdds)) {
+        return false;
+    }
+    if(releaseLogOdds > acquireLogOdds) {
+        if(logLevel <= Error) {
+            ROS_ERROR("IdentificationModule: Release probability must not be above acquire probability");
+        }
+        return false;
+    }
+    if(!nodeHandlePrivate->getParam("staticMethodPipeline", staticMethodPipeline)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Value of staticMethodPipeline not found, using default: %d", DEFAULT_STATIC_METHOD_PIPELINE);
+        }
+        staticMethodPipeline = DEFAULT_STATIC_METHOD_PIPELINE;
+    }
+    if(!nodeHandlePrivate->getParam("identificationThreads", identificationThreads)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Value of identificationThreads not found, using default: %d", DEFAULT_IDENTIFICATION_THREADS);
+        }
+        identificationThreads = DEFAULT_IDENTIFICATION_THREADS;
+    }
+    if(identificationThreads < 1) {
+        if(logLevel <= Error) {
+            ROS_ERROR("IdentificationModule: identificationThreads must be at least 1");
+        }
+        return false;
+    }
+    //Single thread keeps everything on control loop thread without pool
+    if(identificationThreads > 1) {
+        threadPool.Start(identificationThreads);
+    }
+    for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+        methods[i] = pipeline.Get(i);
+        methods[i]->SetThreadPool(identificationThreads > 1 ? &threadPool : NULL);
+    }
     double methodTrustValue;
-    methods[IM_UserId] = new UserID_Method();
     if(!nodeHandlePrivate->getParam("userID_MethodTrust", methodTrustValue)) {
         if(logLevel <= Warn) {
             ROS_WARN("IdentificationModule: Trust value for userID method not found, using default: %f", DEFAULT_USER_ID_METHOD_TRUST);
@@ -47,18 +94,68 @@ bool IdentificationModule::Initialize(ros::NodeHandle *nodeHandlePrivate) {
     else {
         methods[IM_UserId]->SetTrustValue(methodTrustValue);
     }
-    methods[IM_Height] = new Height_Method();
     if(!nodeHandlePrivate->getParam("height_MethodTrust", methodTrustValue)) {
         if(logLevel <= Warn) {
-            ROS_WARN("IdentificationModule: Trust value for height method not found, using default: %f", DEFAULT_USER_ID_METHOD_TRUST);
+            ROS_WARN("IdentificationModule: Trust value for height method not found, using default: %f", DEFAULT_HEIGHT_METHOD_TRUST);
         }
         methods[IM_Height]->SetTrustValue(DEFAULT_HEIGHT_METHOD_TRUST);
     }
     else {
-        methods[IM_UserId]->SetTrustValue(methodTrustValue);
+        methods[IM_Height]->SetTrustValue(methodTrustValue);
+    }
+    if(!nodeHandlePrivate->getParam("bodyProportion_MethodTrust", methodTrustValue)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Trust value for body proportion method not found, using default: %f", DEFAULT_BODY_PROPORTION_METHOD_TRUST);
+        }
+        methods[IM_BodyProportion]->SetTrustValue(DEFAULT_BODY_PROPORTION_METHOD_TRUST);
     }
+    else {
+        methods[IM_BodyProportion]->SetTrustValue(methodTrustValue);
+    }
+    if(!nodeHandlePrivate->getParam("colorAppearance_MethodTrust", methodTrustValue)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Trust value for color appearance method not found, using default: %f", DEFAULT_COLOR_APPEARANCE_METHOD_TRUST);
+        }
+        methods[IM_ColorAppearance]->SetTrustValue(DEFAULT_COLOR_APPEARANCE_METHOD_TRUST);
+    }
+    else {
+        methods[IM_ColorAppearance]->SetTrustValue(methodTrustValue);
+    }
+    //Without image there is nothing to compare, method must not lower rankings of all users
+    if(!SensorsModule::GetInstance().IsColorEnabled()) {
+        methods[IM_ColorAppearance]->SetTrustValue(0.0);
+        if(logLevel <= Info) {
+            ROS_INFO("IdentificationModule: Color capture disabled, color appearance method not trusted");
+        }
+    }
+    for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+        methodStages[i] = DiagnosticsModule::GetInstance().RegisterStage(std::string("identification/") + methods[i]->GetName());
+    }
+    //Cheapest methods run first, so candidates they rule out never reach expensive ones
+    for(int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+        methodOrder[i] = i;
+    }
+    std::stable_sort(methodOrder, methodOrder + IM_NUMBER_OF_METHODS, [this](int a, int b) {
+        return methods[a]->GetCost() < methods[b]->GetCost();
+    });
+    remainingTrust[IM_NUMBER_OF_METHODS] = 0.0;
+    for(int i=IM_NUMBER_OF_METHODS - 1; i >= 0; --i) {
+        remainingTrust[i] = remainingTrust[i + 1] + methods[methodOrder[i]]->GetTrustValue();
+    }
+    ratedPairs = 0;
+    prunedPairs = 0;
+    int maxUsers = DataStorage::GetInstance().GetMaxUsers();
+    beliefs.reserve(2*maxUsers);
+    followedTrack = NO_TRACK;
+    candidateIds.reserve(maxUsers);
+    candidateScores.reserve(maxUsers);
+    candidateRanking.reserve(maxUsers);
+    activeIds.reserve(maxUsers);
+    activeIndices.reserve(maxUsers);
+    pipelineStage = DiagnosticsModule::GetInstance().RegisterStage("identification/static_pipeline");
+    ratingStage = DiagnosticsModule::GetInstance().RegisterStage("identification/rating");
     if(logLevel <= Info) {
-        ROS_INFO("IdentificationModule: Initialized");
+        ROS_INFO("IdentificationModule: Initialized, %s method pipeline, %d threads", staticMethodPipeline ? "static" : "virtual", identificationThreads);
     }
     state = NoTemplate;
     return true;
@@ -66,6 +163,10 @@ bool IdentificationModule::Initialize(ros::NodeHandle *nodeHandlePrivate) {
 
 void IdentificationModule::Update()
 {
+    //Methods push samples of every frame they see, so frame reused by control thread must not be seen twice
+    if(!SensorsModule::GetInstance().IsNewFrame()) {
+        return;
+    }
     switch (state) {
         case IdentificationStates::NoTemplate:
             break;
@@ -79,15 +180,19 @@ void IdentificationModule::Update()
 }
 
 void IdentificationModule::Finish() {
-    for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
-        delete methods[i];
+    if(logLevel <= Info) {
+        ROS_INFO("IdentificationModule: Rated user-method pairs: %lu, pruned: %lu", ratedPairs, prunedPairs);
     }
+    threadPool.Stop();
 }
 
 void IdentificationModule::ClearTemplate() {
     for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
         methods[i]->ClearTemplate();
     }
+    beliefs.clear();
+    followedTrack = NO_TRACK;
+    DataStorage::GetInstance().ResetFollowedUserTrack();
     state = IdentificationStates::NoTemplate;
     if(logLevel <= Info) {
         ROS_INFO("IdentificationModule: Template cleared");
@@ -130,6 +235,15 @@ void IdentificationModule::ContinueSavingTemplate() {
     }
     if(templateState == Ready) {
         state = IdentificationStates::PresentTemplate;
+        //Template user is the escorted person by definition
+        beliefs.clear();
+        followedTrack = TrackerModule::GetInstance().GetTrackId(DataStorage::GetInstance().GetCurrentUserXnId());
+        if(followedTrack != NO_TRACK) {
+            TrackBelief belief;
+            belief.trackId = followedTrack;
+            belief.logOdds = maxLogOdds;
+            beliefs.push_back(belief);
+        }
         if(logLevel <= Info) {
             ROS_INFO("IdentificationModule: Saving template successful");
         }
@@ -143,47 +257,211 @@ void IdentificationModule::ContinueSavingTemplate() {
 }
 
 void IdentificationModule::IdentifyUser() {
-    for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
-        methods[i]->Update();
+    double start;
+    if(staticMethodPipeline) {
+        start = DiagnosticsModule::Now();
+        pipeline.Update();
+        pipelineTime = DiagnosticsModule::Now() - start;
+    }
+    else {
+        for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+            start = DiagnosticsModule::Now();
+            methods[i]->Update();
+            methodTimes[i] = DiagnosticsModule::Now() - start;
+        }
     }
     XnUserID previousUser = DataStorage::GetInstance().GetCurrentUserXnId();
-    std::set<XnUserID>* presentUsers = DataStorage::GetInstance().GetPresentUsersSet();
-    if(presentUsers->size()>0) {
-        std::set<XnUserID>::iterator iter;
-        int index = 0;
-        float usersRanking[presentUsers->size()];
-        XnUserID usersIds[presentUsers->size()];
-        for (iter = presentUsers->begin(); iter != presentUsers->end(); ++iter) {
-            usersIds[index] = *iter;
-            usersRanking[index] = 0.0;
-            ++index;
-        }
-        for (index = 0; index < presentUsers->size(); ++index) {
-            for (int i = 0; i < IM_NUMBER_OF_METHODS; ++i) {
-                usersRanking[index] += (methods[i]->RateUser(usersIds[index]) * methods[i]->GetTrustValue());
+    UserTable const& users = DataStorage::GetInstance().GetUserTable();
+    if(users.GetCount()>0) {
+        candidateIds.resize(users.GetCount());
+        int count = users.GetPresentUsers(candidateIds.data());
+        candidateScores.resize(count);
+        candidateRanking.resize(count);
+        double ratingStart = DiagnosticsModule::Now();
+        RateCandidates(count);
+        DiagnosticsModule::GetInstance().RecordStage(ratingStage, DiagnosticsModule::Now() - ratingStart);
+        UpdateBeliefs(count);
+        XnUserID newUser = DecideUser(count);
+        DataStorage::GetInstance().SetCurrentUserXnId(newUser);
+        if(newUser != NO_USER && previousUser != newUser) {
+            if (logLevel <= Info) {
+                ROS_INFO("IdentificationModule: Switched to user %d", newUser);
             }
         }
-        int bestMatchingUserIndex = 0;
-        for (index = 1; index < presentUsers->size(); ++index) {
-            if (usersRanking[bestMatchingUserIndex] < usersRanking[index]) {
-                bestMatchingUserIndex = index;
+    }
+    else {
+        DataStorage::GetInstance().SetCurrentUserXnId(NO_USER);
+    }
+    if(staticMethodPipeline) {
+        //Methods are not timed separately, update and late update are reported together
+        start = DiagnosticsModule::Now();
+        pipeline.LateUpdate();
+        pipelineTime += DiagnosticsModule::Now() - start;
+        DiagnosticsModule::GetInstance().RecordStage(pipelineStage, pipelineTime);
+    }
+    else {
+        for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+            start = DiagnosticsModule::Now();
+            methods[i]->LateUpdate();
+            methodTimes[i] += DiagnosticsModule::Now() - start;
+            DiagnosticsModule::GetInstance().RecordStage(methodStages[i], methodTimes[i]);
+        }
+    }
+}
+
+void IdentificationModule::RateCandidates(int count) {
+    std::fill(candidateRanking.begin(), candidateRanking.end(), 0.0f);
+    activeIds.assign(candidateIds.begin(), candidateIds.begin() + count);
+    activeIndices.resize(count);
+    for(int i=0; i < count; ++i) {
+        activeIndices[i] = i;
+    }
+    int active = count;
+    double start;
+    for(int k=0; k < IM_NUMBER_OF_METHODS && active > 0; ++k) {
+        int method = methodOrder[k];
+        start = DiagnosticsModule::Now();
+        RateActiveCandidates(method, active);
+        if(!staticMethodPipeline) {
+            methodTimes[method] += DiagnosticsModule::Now() - start;
+        }
+        ratedPairs += active;
+        //Candidates that can not reach threshold even with full score
+        //from all remaining methods are dropped from further rating. Dropped candidate is credited
+        //with full score of methods it skipped, so it keeps the least negative evidence it could have had
+        //and stays below threshold, while fully rated candidates keep their graded ranking
+        float trust = methods[method]->GetTrustValue();
+        if(active == count) {
+            Identification_Method::AccumulateWeighted(candidateScores.data(), trust, count, candidateRanking.data());
+        }
+        else {
+            for(int i=0; i < active; ++i) {
+                candidateRanking[activeIndices[i]] += candidateScores[i]*trust;
             }
         }
-        if (usersRanking[bestMatchingUserIndex] >= DEFAULT_IDENTIFICATION_THRESHOLD) {
-            DataStorage::GetInstance().SetCurrentUserXnId(usersIds[bestMatchingUserIndex]);
-            if(previousUser != usersIds[bestMatchingUserIndex]) {
-                if (logLevel <= Info) {
-                    ROS_INFO("IdentificationModule: Switched to user %d", usersIds[bestMatchingUserIndex]);
-                }
+        int kept = 0;
+        for(int i=0; i < active; ++i) {
+            if(candidateRanking[activeIndices[i]] + remainingTrust[k + 1] >= identificationThreshold) {
+                activeIds[kept] = activeIds[i];
+                activeIndices[kept] = activeIndices[i];
+                ++kept;
+            }
+            else {
+                candidateRanking[activeIndices[i]] += remainingTrust[k + 1];
             }
-        } else {
-            DataStorage::GetInstance().SetCurrentUserXnId(NO_USER);
         }
+        prunedPairs += (active - kept)*(IM_NUMBER_OF_METHODS - k - 1);
+        active = kept;
     }
-    else {
-        DataStorage::GetInstance().SetCurrentUserXnId(NO_USER);
+}
+
+void IdentificationModule::RateActiveCandidates(int method, int active) {
+    //Every chunk writes scores of its own candidates only, so result does not depend on scheduling
+    auto rateChunk = [this, method](int begin, int end) {
+        if(staticMethodPipeline) {
+            pipeline.RateUsersAt(method, activeIds.data() + begin, end - begin, candidateScores.data() + begin);
+        }
+        else {
+            methods[method]->RateUsers(activeIds.data() + begin, end - begin, candidateScores.data() + begin);
+        }
+    };
+    int tasks = identificationThreads*IDENTIFICATION_TASKS_PER_THREAD;
+    threadPool.ParallelFor(active, (active + tasks - 1)/tasks, rateChunk);
+}
+
+void IdentificationModule::UpdateBeliefs(int count) {
+    //Score above threshold is evidence for, below threshold against, both relative to total trust
+    double totalTrust = 0.0;
+    for(int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
+        totalTrust += methods[i]->GetTrustValue();
     }
-    for( int i=0; i < IM_NUMBER_OF_METHODS; ++i) {
-        methods[i]->LateUpdate();
+    if(totalTrust <= 0.0) {
+        return;
+    }
+    double threshold = identificationThreshold/totalTrust;
+    TrackerModule& tracker = TrackerModule::GetInstance();
+    for(int i=0; i < count; ++i) {
+        unsigned long trackId = tracker.GetTrackId(candidateIds[i]);
+        if(trackId == NO_TRACK) {
+            continue;
+        }
+        TrackBelief* belief = FindBelief(trackId);
+        if(belief == NULL) {
+            TrackBelief newBelief;
+            newBelief.trackId = trackId;
+            newBelief.logOdds = 0.0;
+            beliefs.push_back(newBelief);
+            belief = &beliefs.back();
+        }
+        belief->logOdds += evidenceGain*(candidateRanking[i]/totalTrust - threshold);
+        belief->logOdds = std::max(-maxLogOdds, std::min(maxLogOdds, belief->logOdds));
     }
-}
\ No newline at end of file
+    //Beliefs live as long as their tracks, so briefly lost person keeps its identity
+    int kept = 0;
+    for(int i=0; i < beliefs.size(); ++i) {
+        if(tracker.IsTrackAlive(beliefs[i].trackId)) {
+            beliefs[kept++] = beliefs[i];
+        }
+    }
+    beliefs.resize(kept);
+}
+
+XnUserID IdentificationModule::DecideUser(int count) {
+    TrackerModule& tracker = TrackerModule::GetInstance();
+    XnUserID bestUser = NO_USER;
+    unsigned long bestTrack = NO_TRACK;
+    double bestLogOdds = -maxLogOdds;
+    for(int i=0; i < count; ++i) {
+        TrackBelief* belief = FindBelief(tracker.GetTrackId(candidateIds[i]));
+        if(belief != NULL && (bestUser == NO_USER || belief->logOdds > bestLogOdds)) {
+            bestUser = candidateIds[i];
+            bestTrack = belief->trackId;
+            bestLogOdds = belief->logOdds;
+        }
+    }
+    //Hysteresis, followed person is kept until its belief drops below release level
+    //or another person is strictly more likely and above acquire level
+    XnUserID followedUser = tracker.GetUserOfTrack(followedTrack);
+    if(followedUser != NO_USER) {
+        TrackBelief* belief = FindBelief(followedTrack);
+        if(belief == NULL || belief->logOdds < releaseLogOdds) {
+            //Released person has to reach acquire level again
+            followedTrack = NO_TRACK;
+        }
+        else if(bestLogOdds <= belief->logOdds || bestLogOdds < acquireLogOdds) {
+            return followedUser;
+        }
+    }
+    if(bestUser != NO_USER && bestLogOdds >= acquireLogOdds) {
+        followedTrack = bestTrack;
+        return bestUser;
+    }
+    return NO_USER;
+}
+
+TrackBelief* IdentificationModule::FindBelief(unsigned long trackId) {
+    for(int i=0; i < beliefs.size(); ++i) {
+        if(beliefs[i].trackId == trackId) {
+            return &beliefs[i];
+        }
+    }
+    return NULL;
+}
+
+bool IdentificationModule::ReadProbability(ros::NodeHandle *nodeHandlePrivate, const char* name, double defaultValue, double& logOdds) {
+    double probability;
+    if(!nodeHandlePrivate->getParam(name, probability)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("IdentificationModule: Value of %s not found, using default: %f", name, defaultValue);
+        }
+        probability = defaultValue;
+    }
+    if(probability <= 0.0 || probability >= 1.0) {
+        if(logLevel <= Error) {
+            ROS_ERROR("IdentificationModule: Requested invalid %s: %f", name, probability);
+        }
+        return false;
+    }
+    logOdds = log(probability/(1.0 - probability));
+    return true;
+}
@@ -5,14 +5,31 @@
 #define DEFAULT_IDENTIFICATION_THRESHOLD 0.9
 #define DEFAULT_USER_ID_METHOD_TRUST 0.2
 #define DEFAULT_HEIGHT_METHOD_TRUST 1.0
+#define DEFAULT_BODY_PROPORTION_METHOD_TRUST 0.5
+#define DEFAULT_COLOR_APPEARANCE_METHOD_TRUST 0.5
+#define DEFAULT_STATIC_METHOD_PIPELINE false
+#define DEFAULT_IDENTIFICATION_EVIDENCE_GAIN 2.0
+#define DEFAULT_IDENTIFICATION_MAX_LOG_ODDS 4.0
+#define DEFAULT_IDENTIFICATION_ACQUIRE_PROBABILITY 0.8
+#define DEFAULT_IDENTIFICATION_RELEASE_PROBABILITY 0.3
+#define DEFAULT_IDENTIFICATION_THREADS 1
+#define IDENTIFICATION_TASKS_PER_THREAD 4
 
+#include <vector>
+#include <algorithm>
 #include <ros/ros.h>
 #include <ros/package.h>
 #include "../Common.h"
 #include "SensorsModule.h"
+#include "TrackerModule.h"
+#include "DiagnosticsModule.h"
+#include "../Utilities/ThreadPool.h"
 #include "IdentificationMethods/Identification_Method.h"
 #include "IdentificationMethods/UserID_Method.h"
 #include "IdentificationMethods/Height_Method.h"
+#include "IdentificationMethods/BodyProportion_Method.h"
+#include "IdentificationMethods/ColorAppearance_Method.h"
+#include "IdentificationMethods/Identification_Pipeline.h"
 
 
 enum IdentificationStates {
@@ -20,7 +37,17 @@ enum IdentificationStates {
 };
 
 enum ImplementedMethods {
-    IM_UserId, IM_Height, IM_NUMBER_OF_METHODS
+    IM_UserId, IM_Height, IM_BodyProportion, IM_ColorAppearance, IM_NUMBER_OF_METHODS
+};
+
+//Method types in the order of ImplementedMethods, evaluation order is given by their costs
+typedef Identification_Pipeline<UserID_Method, Height_Method, BodyProportion_Method, ColorAppearance_Method> ImplementedPipeline;
+static_assert(ImplementedPipeline::size == IM_NUMBER_OF_METHODS, "ImplementedPipeline does not match ImplementedMethods");
+
+//Log-odds that track is the escorted person
+struct TrackBelief {
+    unsigned long trackId;
+    double logOdds;
 };
 
 class IdentificationModule {
@@ -39,8 +66,32 @@ public:
 private:
     LogLevels logLevel;
     double identificationThreshold;
+    double evidenceGain;
+    double maxLogOdds;
+    double acquireLogOdds;
+    double releaseLogOdds;
+    unsigned long followedTrack;
+    std::vector<TrackBelief> beliefs;
     IdentificationStates state;
+    bool staticMethodPipeline;
+    ImplementedPipeline pipeline;
+    int identificationThreads;
+    ThreadPool threadPool;
     Identification_Method* methods[ImplementedMethods::IM_NUMBER_OF_METHODS];
+    int methodStages[ImplementedMethods::IM_NUMBER_OF_METHODS];
+    double methodTimes[ImplementedMethods::IM_NUMBER_OF_METHODS];
+    int methodOrder[ImplementedMethods::IM_NUMBER_OF_METHODS];
+    double remainingTrust[ImplementedMethods::IM_NUMBER_OF_METHODS + 1];
+    unsigned long ratedPairs;
+    unsigned long prunedPairs;
+    std::vector<XnUserID> candidateIds;
+    std::vector<float> candidateScores;
+    std::vector<float> candidateRanking;
+    std::vector<XnUserID> activeIds;
+    std::vector<int> activeIndices;
+    double pipelineTime;
+    int pipelineStage;
+    int ratingStage;
 
     IdentificationModule() {}
     IdentificationModule(const IdentificationModule &);
@@ -48,6 +99,12 @@ private:
     ~IdentificationModule() {}
     void ContinueSavingTemplate();
     void IdentifyUser();
+    void RateCandidates(int count);
+    void RateActiveCandidates(int method, int active);
+    void UpdateBeliefs(int count);
+    XnUserID DecideUser(int count);
+    TrackBelief* FindBelief(unsigned long trackId);
+    bool ReadProbability(ros::NodeHandle *nodeHandlePrivate, const char* name, double defaultValue, double& logOdds);
 };
 
 #endif //ELEKTRON_ESCORT_IDENTIFICATION_MODULE_H
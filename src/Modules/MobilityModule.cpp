@@ -1,4 +1,5 @@
 #include "MobilityModule.h"
+#include "DiagnosticsModule.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -95,12 +96,18 @@ void MobilityModule::Update() {
 }
 
 void MobilityModule::SetState(DrivesState newState) {
+    static const char* stateNames[] = {"mobility/stop", "mobility/follow_user", "mobility/search_for_user"};
     state = newState;
+    DiagnosticsModule::GetInstance().TraceInstant(stateNames[newState], "state");
     if(logLevel <= Debug) {
         ROS_DEBUG("MobilityModule: New state: %d", newState);
     }
 }
 
+geometry_msgs::Twist MobilityModule::GetLastVelocity() {
+    return lastVelocity;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
 //Private
@@ -109,22 +116,30 @@ void MobilityModule::StopStateUpdate() {
     geometry_msgs::Twist velocity;
     velocity.linear.x = 0;
     velocity.angular.z = 0;
-    publisher.publish(velocity);
+    Publish(velocity);
 }
 
 void MobilityModule::FollowUserStateUpdate() {
     geometry_msgs::Twist velocity;
     velocity.linear.x = 0;
     velocity.angular.z = 0;
-    if(DataStorage::GetInstance().GetCurrentUserXnId() == NO_USER) {
-        publisher.publish(velocity);
+    if(DataStorage::GetInstance().GetCurrentUserXnId() == NO_USER && !DataStorage::GetInstance().IsFollowedUserTracked()) {
+        Publish(velocity);
         if(logLevel <= Warn){
             ROS_WARN("MobilityModule: No user to follow");
         }
     }
     else {
         XnPoint3D currentUserLocation;
-        SensorsModule::GetInstance().GetUserGenerator().GetCoM(DataStorage::GetInstance().GetCurrentUserXnId(), currentUserLocation);
+        if(DataStorage::GetInstance().GetCurrentUserXnId() != NO_USER) {
+            currentUserLocation = DataStorage::GetInstance().GetUserCoM(DataStorage::GetInstance().GetCurrentUserXnId());
+        }
+        else {
+            currentUserLocation = DataStorage::GetInstance().GetFollowedUserPredictedPosition();
+            if(logLevel <= Debug) {
+                ROS_DEBUG("MobilityModule: Following predicted position: %f %f", currentUserLocation.X, currentUserLocation.Z);
+            }
+        }
         if(currentUserLocation.Z > distanceToKeep) {
             if(currentUserLocation.Z >= maxLinearSpeedDistance) {
                 velocity.linear.x = maxLinearSpeed;
@@ -152,7 +167,7 @@ void MobilityModule::FollowUserStateUpdate() {
                 velocity.angular.z *= -maxFollowingTurningSpeed;
             }
         }
-        publisher.publish(velocity);
+        Publish(velocity);
     }
 }
 
@@ -166,12 +181,18 @@ void MobilityModule::SearchForUserStateUpdate() {
         }
     }
     else {
-        if(DataStorage::GetInstance().GetLastUserPosition().X >= 0) {
+        //Turn toward where the user was heading, not only where it was seen last
+        if(DataStorage::GetInstance().GetFollowedUserPredictedPosition().X >= 0) {
             velocity.angular.z = -searchingTurningSpeed;
         }
         else {
             velocity.angular.z = searchingTurningSpeed;
         }
     }
+    Publish(velocity);
+}
+
+void MobilityModule::Publish(geometry_msgs::Twist const& velocity) {
+    lastVelocity = velocity;
     publisher.publish(velocity);
 }
\ No newline at end of file
@@ -34,11 +34,13 @@ public:
     bool Initialize(ros::NodeHandle *nodeHandlePublic, ros::NodeHandle *nodeHandlePrivate);
     void Update();
     void SetState(DrivesState newState);
+    geometry_msgs::Twist GetLastVelocity();
 
 private:
     LogLevels logLevel;
     DrivesState state;
     ros::Publisher publisher;
+    geometry_msgs::Twist lastVelocity;
     double distanceToKeep;
     double maxLinearSpeed;
     double maxLinearSpeedDistance;
@@ -54,6 +56,7 @@ private:
     void StopStateUpdate();
     void FollowUserStateUpdate();
     void SearchForUserStateUpdate();
+    void Publish(geometry_msgs::Twist const& velocity);
 };
 
 #endif //ELEKTRON_ESCORT_MOBILITY_MODULE_H
@@ -0,0 +1,163 @@
+#include "ReplayModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool ReplayModule::Initialize(ros::NodeHandle *nodeHandlePrivate) {
+    int _logLevel;
+    if(!nodeHandlePrivate->getParam("replayModuleLogLevel", _logLevel)) {
+        ROS_WARN("ReplayModule: Log level not found, using default");
+        logLevel = DEFAULT_REPLAY_MODULE_LOG_LEVEL;
+    }
+    else {
+        switch (_logLevel) {
+            case 0:
+                logLevel = Debug;
+                break;
+            case 1:
+                logLevel = Info;
+                break;
+            case 2:
+                logLevel = Warn;
+                break;
+            case 3:
+                logLevel = Error;
+                break;
+            default:
+                ROS_WARN("ReplayModule: Requested invalid log level, using default");
+                logLevel = DEFAULT_REPLAY_MODULE_LOG_LEVEL;
+                break;
+        }
+    }
+    if(!nodeHandlePrivate->getParam("replayFile", replayFile)) {
+        replayFile = "";
+    }
+    if(!nodeHandlePrivate->getParam("replayAsFastAsPossible", asFastAsPossible)) {
+        asFastAsPossible = DEFAULT_REPLAY_AS_FAST_AS_POSSIBLE;
+    }
+    if(!nodeHandlePrivate->getParam("replayOutputFile", replayOutputFile)) {
+        replayOutputFile = "";
+    }
+    if(!nodeHandlePrivate->getParam("skeletonLogFile", skeletonLogFile)) {
+        skeletonLogFile = "";
+    }
+    if(!replayOutputFile.empty()) {
+        output.open(replayOutputFile.c_str(), std::ofstream::out | std::ofstream::trunc);
+        if(!output.is_open()) {
+            if(logLevel <= Error) {
+                ROS_ERROR("ReplayModule: Failed to open output file: %s", replayOutputFile.c_str());
+            }
+            return false;
+        }
+        output << "frame_id,timestamp,identification_state,current_user,linear_x,angular_z" << std::endl;
+    }
+    processedFrames = 0;
+    lastFrameId = 0;
+    lastFrameTimestamp = -1.0;
+    startTime = std::chrono::steady_clock::now();
+    if(logLevel <= Info) {
+        if(IsReplaying()) {
+            ROS_INFO("ReplayModule: Initialized, replaying: %s%s", replayFile.c_str(), asFastAsPossible ? " as fast as possible" : "");
+        }
+        else {
+            ROS_INFO("ReplayModule: Initialized%s", asFastAsPossible ? ", as fast as possible for non-live sources" : "");
+        }
+    }
+    return true;
+}
+
+void ReplayModule::Update() {
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    bool newFrame = frame.frameId != lastFrameId;
+    if(newFrame) {
+        ++processedFrames;
+        lastFrameId = frame.frameId;
+    }
+    if(skeletonLog.IsRunning()) {
+        //Events processed in ticks without new frame are stored with the next one
+        std::vector<SensorEvent> const& events = SensorsModule::GetInstance().GetProcessedEvents();
+        skeletonLogEvents.insert(skeletonLogEvents.end(), events.begin(), events.end());
+        if(newFrame) {
+            geometry_msgs::Twist velocity = MobilityModule::GetInstance().GetLastVelocity();
+            skeletonLog.Append(frame, skeletonLogEvents, velocity.linear.x, velocity.angular.z);
+            skeletonLogEvents.clear();
+        }
+    }
+    if(output.is_open()) {
+        geometry_msgs::Twist velocity = MobilityModule::GetInstance().GetLastVelocity();
+        XnUserID currentUser = DataStorage::GetInstance().GetSnapshot().currentUserXnId;
+        output << frame.frameId << ',' << frame.timestamp << ',' << IdentificationModule::GetInstance().GetState() << ',';
+        if(currentUser == NO_USER) {
+            output << "none";
+        }
+        else {
+            output << currentUser;
+        }
+        output << ',' << velocity.linear.x << ',' << velocity.angular.z << '\n';
+    }
+}
+
+void ReplayModule::Finish() {
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    if(logLevel <= Info) {
+        ROS_INFO("ReplayModule: Processed %lu frames in %f s, %f frames per second", processedFrames, seconds,
+                 seconds > 0.0 ? processedFrames/seconds : 0.0);
+    }
+    if(output.is_open()) {
+        output.close();
+    }
+    if(skeletonLog.IsRunning()) {
+        skeletonLog.Stop();
+        if(logLevel <= Info) {
+            ROS_INFO("ReplayModule: Skeleton log frames written: %lu, dropped: %lu", skeletonLog.GetWrittenFramesCount(),
+                     skeletonLog.GetDroppedFramesCount());
+        }
+    }
+}
+
+bool ReplayModule::StartSkeletonLog() {
+    //Needs users count and smoothing of initialized sensors, so it is started after other modules
+    if(skeletonLogFile.empty()) {
+        return true;
+    }
+    skeletonLogEvents.reserve(EVENT_QUEUE_CAPACITY);
+    SensorsModule& sensors = SensorsModule::GetInstance();
+    if(!skeletonLog.Start(skeletonLogFile, DataStorage::GetInstance().GetMaxUsers(), sensors.IsJointSmoothed(), !sensors.IsLive())) {
+        if(logLevel <= Error) {
+            ROS_ERROR("ReplayModule: Failed to start skeleton log: %s", skeletonLogFile.c_str());
+        }
+        return false;
+    }
+    if(logLevel <= Info) {
+        ROS_INFO("ReplayModule: Recording skeleton log: %s", skeletonLogFile.c_str());
+    }
+    return true;
+}
+
+bool ReplayModule::IsReplaying() {
+    return !replayFile.empty();
+}
+
+bool ReplayModule::IsAsFastAsPossible() {
+    //Live sensor always runs at its own pace
+    return asFastAsPossible && !SensorsModule::GetInstance().IsLive();
+}
+
+std::string ReplayModule::GetReplayFile() {
+    return replayFile;
+}
+
+double ReplayModule::GetFrameTimeElapsed(double defaultTimeElapsed) {
+    //Recorded and synthetic timestamps keep runs deterministic regardless of processing speed
+    if(SensorsModule::GetInstance().IsLive()) {
+        return defaultTimeElapsed;
+    }
+    double timestamp = SensorsModule::GetInstance().GetFrame().timestamp;
+    double timeElapsed = defaultTimeElapsed;
+    if(lastFrameTimestamp >= 0.0 && timestamp >= lastFrameTimestamp) {
+        timeElapsed = timestamp - lastFrameTimestamp;
+    }
+    lastFrameTimestamp = timestamp;
+    return timeElapsed;
+}
@@ -0,0 +1,56 @@
+#ifndef ELEKTRON_ESCORT_REPLAY_MODULE_H
+#define ELEKTRON_ESCORT_REPLAY_MODULE_H
+
+#define DEFAULT_REPLAY_MODULE_LOG_LEVEL Info
+#define DEFAULT_REPLAY_AS_FAST_AS_POSSIBLE false
+
+#include <string>
+#include <chrono>
+#include <fstream>
+#include <vector>
+#include <ros/ros.h>
+#include <ros/package.h>
+#include "../Common.h"
+#include "SensorsModule.h"
+#include "IdentificationModule.h"
+#include "MobilityModule.h"
+#include "DataStorage.h"
+#include "SkeletonLog.h"
+
+
+class ReplayModule {
+public:
+    static ReplayModule &GetInstance() {
+        static ReplayModule instance;
+        return instance;
+    }
+    bool Initialize(ros::NodeHandle *nodeHandlePrivate);
+    void Update();
+    void Finish();
+    bool StartSkeletonLog();
+    bool IsReplaying();
+    bool IsAsFastAsPossible();
+    std::string GetReplayFile();
+    double GetFrameTimeElapsed(double defaultTimeElapsed);
+
+private:
+    LogLevels logLevel;
+    std::string replayFile;
+    std::string replayOutputFile;
+    std::string skeletonLogFile;
+    bool asFastAsPossible;
+    std::ofstream output;
+    SkeletonLogWriter skeletonLog;
+    std::vector<SensorEvent> skeletonLogEvents;
+    unsigned long processedFrames;
+    unsigned long lastFrameId;
+    double lastFrameTimestamp;
+    std::chrono::steady_clock::time_point startTime;
+
+    ReplayModule() {}
+    ReplayModule(const ReplayModule &);
+    ReplayModule &operator=(const ReplayModule &);
+    ~ReplayModule() {}
+};
+
+#endif //ELEKTRON_ESCORT_REPLAY_MODULE_H
@@ -1,4 +1,12 @@
 #include "SensorsModule.h"
+#include "SkeletonSources/OpenNI_Source.h"
+#include "SkeletonSources/Synthetic_Source.h"
+#include "SkeletonSources/SkeletonLog_Source.h"
+#include "DiagnosticsModule.h"
+
+static const char* eventNames[SE_NUMBER_OF_TYPES] = {
+    "new_user", "user_exit", "user_reenter", "lost_user", "pose_detected", "calibration_start", "calibration_complete"
+};
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -30,248 +38,533 @@ bool SensorsModule::Initialize(ros::NodeHandle* nodeHandlePrivate) {
                 break;
         }
     }
-    XnStatus result = context.Init();
-    if (result != XN_STATUS_OK) {
-        if(logLevel <= Error) {
-            ROS_ERROR("SensorsModule: Initialization from Xml file failed: %s", xnGetStatusString(result));
+    if(!nodeHandlePrivate->getParam("sensorSource", sensorSource)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of sensorSource not found, using default: %s", DEFAULT_SENSOR_SOURCE);
         }
-        return false;
+        sensorSource = DEFAULT_SENSOR_SOURCE;
     }
-    result = context.FindExistingNode(XN_NODE_TYPE_USER, userGenerator);
-    if (result != XN_STATUS_OK) {
-        result = userGenerator.Create(context);
+    if(!nodeHandlePrivate->getParam("colorAppearance", colorEnabled)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of colorAppearance not found, using default: %d", DEFAULT_COLOR_APPEARANCE);
+        }
+        colorEnabled = DEFAULT_COLOR_APPEARANCE;
     }
-    if (result != XN_STATUS_OK) {
-        if(logLevel <= Error) {
-            ROS_ERROR("SensorsModule: Create user generator failed: %s", xnGetStatusString(result));
+    if(!nodeHandlePrivate->getParam("userSilhouettes", silhouettesEnabled)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of userSilhouettes not found, using default: %d", DEFAULT_USER_SILHOUETTES);
         }
-        return false;
+        silhouettesEnabled = DEFAULT_USER_SILHOUETTES;
     }
-    if (!userGenerator.IsCapabilitySupported(XN_CAPABILITY_SKELETON)) {
-        if(logLevel <= Error) {
-            ROS_ERROR("SensorsModule: User generator doesn't support skeleton");
+    if(!nodeHandlePrivate->getParam("floorPlane", floorEnabled)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of floorPlane not found, using default: %d", DEFAULT_FLOOR_PLANE);
         }
+        floorEnabled = DEFAULT_FLOOR_PLANE;
+    }
+    if(!ReadJointSmoothing(nodeHandlePrivate)) {
         return false;
     }
-    if (userGenerator.GetSkeletonCap().NeedPoseForCalibration()) {
-        if (!userGenerator.IsCapabilitySupported(XN_CAPABILITY_POSE_DETECTION)) {
-            if(logLevel <= Error) {
-                ROS_ERROR("SensorsModule: Calibration pose required, but not supported");
-            }
-            return false;
-        }
+    if(sensorSource == "openni") {
+        source = new OpenNI_Source();
+    }
+    else if(sensorSource == "synthetic") {
+        source = new Synthetic_Source();
     }
-    result = context.StartGeneratingAll();
-    if (result != XN_STATUS_OK) {
+    else if(sensorSource == "skeleton_log") {
+        source = new SkeletonLog_Source();
+    }
+    else {
         if(logLevel <= Error) {
-            ROS_ERROR("SensorsModule: Start generating all failed: %s", xnGetStatusString(result));
+            ROS_ERROR("SensorsModule: Unknown sensor source: %s", sensorSource.c_str());
         }
         return false;
     }
-    userGenerator.GetSkeletonCap().SetSkeletonProfile(XN_SKEL_PROFILE_ALL);
+    if(!source->Initialize(nodeHandlePrivate)) {
+        return false;
+    }
     state = Off;
-    stateMutex.lock();
-    userGenerator.RegisterUserCallbacks(User_NewUser, User_LostUser, NULL, userCallbacksHandle);
-    userGenerator.RegisterToUserExit(User_Exit, NULL, userCallbacksHandle);
-    userGenerator.RegisterToUserReEnter(User_ReEnter, NULL, userCallbacksHandle);
-    userGenerator.GetSkeletonCap().RegisterToCalibrationStart(UserCalibration_CalibrationStart, NULL, calibrationCallbacksHandle);
-    userGenerator.GetSkeletonCap().RegisterToCalibrationComplete(UserCalibration_CalibrationComplete, NULL, calibrationCallbacksHandle);
-    userGenerator.GetPoseDetectionCap().RegisterToPoseDetected(UserPose_PoseDetected, NULL, poseCallbacksHandle);
-    userGenerator.GetSkeletonCap().SetSmoothing(SMOOTHING_FACTOR);
-    stateMutex.unlock();
+    eventQueue.Reserve(EVENT_QUEUE_CAPACITY);
+    commandQueue.Reserve(COMMAND_QUEUE_CAPACITY);
+    droppedCommands = 0;
+    calibrationData = false;
+    processedEvents.reserve(EVENT_QUEUE_CAPACITY);
+    for(int i=0; i < SE_NUMBER_OF_TYPES; ++i) {
+        eventCounts[i] = 0;
+    }
+    droppedEvents = 0;
+    capturedFrames = 0;
+    framePool.clear();
+    for(int i=0; i < FRAME_POOL_SIZE; ++i) {
+        framePool.push_back(std::make_shared<SkeletonFrame>());
+        framePool.back()->Resize(DataStorage::GetInstance().GetMaxUsers());
+    }
+    latestFrame = framePool[0];
+    currentFrame = framePool[0];
     if(logLevel <= Info) {
-        ROS_INFO("SensorsModule: Initialized");
+        ROS_INFO("SensorsModule: Initialized, source: %s, color: %s, silhouettes: %s, floor: %s", sensorSource.c_str(),
+                 colorEnabled ? "on" : "off", silhouettesEnabled ? "on" : "off", floorEnabled ? "on" : "off");
     }
     return true;
 }
 
 void SensorsModule::Update() {
-    context.WaitAnyUpdateAll();
+    newFrame = true;
+    if(captureThreadRunning) {
+        frameMutex.lock();
+        if(currentFrame == latestFrame) {
+            newFrame = false;
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: No new frame since last update, reusing frame %lu", currentFrame->frameId);
+            }
+        }
+        currentFrame = latestFrame;
+        frameMutex.unlock();
+    }
+    else {
+        Capture();
+        currentFrame = latestFrame;
+    }
+    DiagnosticsModule& diagnostics = DiagnosticsModule::GetInstance();
+    if(newFrame && diagnostics.IsTracing()) {
+        //Spans are recorded by the control thread only, capture thread leaves its times in the frame
+        diagnostics.TraceSpan("capture", currentFrame->captureStart, currentFrame->captureEnd,
+                              captureThreadRunning ? TT_Sensor : TT_Control);
+    }
+    processedEvents.clear();
+    ProcessEvents();
 }
 
 void SensorsModule::Finish() {
-    context.Release();
+    StopCaptureThread();
+    if(logLevel <= Info) {
+        ROS_INFO("SensorsModule: Events new: %lu, exit: %lu, reenter: %lu, lost: %lu, pose: %lu, calibration start: %lu, calibration complete: %lu, dropped: %lu",
+                 eventCounts[SE_NewUser], eventCounts[SE_UserExit], eventCounts[SE_UserReEnter], eventCounts[SE_LostUser],
+                 eventCounts[SE_PoseDetected], eventCounts[SE_CalibrationStart], eventCounts[SE_CalibrationComplete],
+                 droppedEvents.load());
+    }
+    if(source != NULL) {
+        source->Finish();
+        delete source;
+        source = NULL;
+    }
+}
+
+void SensorsModule::StartCaptureThread() {
+    if(captureThreadRunning) {
+        return;
+    }
+    captureThreadRunning = true;
+    captureThread = std::thread(&SensorsModule::CaptureThreadLoop, this);
+    if(logLevel <= Info) {
+        ROS_INFO("SensorsModule: Capture thread started");
+    }
+}
+
+void SensorsModule::StopCaptureThread() {
+    if(!captureThreadRunning) {
+        return;
+    }
+    captureThreadRunning = false;
+    if(captureThread.joinable()) {
+        captureThread.join();
+    }
+    if(logLevel <= Info) {
+        ROS_INFO("SensorsModule: Capture thread stopped after %lu frames", capturedFrames);
+    }
+}
+
+bool SensorsModule::IsCaptureThreadRunning() {
+    return captureThreadRunning;
+}
+
+bool SensorsModule::IsLive() {
+    return source == NULL || source->IsLive();
+}
+
+bool SensorsModule::IsEndOfRecording() {
+    return source != NULL && source->IsEndOfData();
+}
+
+//False when capture thread had no new frame for this tick and current one is processed again
+bool SensorsModule::IsNewFrame() {
+    return newFrame;
+}
+
+//Control thread sleeps until capture thread publishes frame not taken yet, timeout keeps loop going when sensor stalls
+void SensorsModule::WaitForFrame(double timeout) {
+    if(!captureThreadRunning) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(frameMutex);
+    frameCondition.wait_for(lock, std::chrono::duration<double>(timeout), [this]() {
+        return latestFrame != currentFrame;
+    });
+}
+
+const SkeletonFrame& SensorsModule::GetFrame() {
+    return *currentFrame;
 }
 
 LogLevels SensorsModule::GetLogLevel() {
     return logLevel;
 }
 
-xn::UserGenerator SensorsModule::GetUserGenerator() {
-    return userGenerator;
+bool SensorsModule::IsColorEnabled() {
+    return colorEnabled;
 }
 
-void SensorsModule::LockStateMutex() {
-    stateMutex.lock();
+bool SensorsModule::IsSilhouettesEnabled() {
+    return silhouettesEnabled;
 }
 
-void SensorsModule::UnlockStateMutex() {
-    stateMutex.unlock();
+bool SensorsModule::IsFloorEnabled() {
+    return floorEnabled;
+}
+
+bool SensorsModule::IsJointSmoothed() {
+    return jointSmoothing || (source != NULL && source->IsSmoothed());
+}
+
+Skeleton_Source* SensorsModule::GetSource() {
+    return source;
+}
+
+std::vector<SensorEvent> const& SensorsModule::GetProcessedEvents() {
+    return processedEvents;
 }
 
 SensorsState SensorsModule::GetState() {
     return state;
 }
 
+unsigned long SensorsModule::GetEventCount(SensorEventType type) {
+    return eventCounts[type];
+}
+
+unsigned long SensorsModule::GetDroppedEventsCount() {
+    return droppedEvents;
+}
+
 void SensorsModule::TurnSensorOff() {
-    stateMutex.lock();
-    XnUInt16 numberOfUsers = userGenerator.GetNumberOfUsers();
-    XnUserID userIds[numberOfUsers];
-    userGenerator.GetUsers(userIds, numberOfUsers);
-    for(int i=0; i < numberOfUsers; ++i) {
-        if(userGenerator.GetSkeletonCap().IsCalibrating(userIds[i])) {
-            userGenerator.GetSkeletonCap().AbortCalibration(userIds[i]);
-        }
-        if(userGenerator.GetSkeletonCap().IsTracking(userIds[i])) {
-            userGenerator.GetSkeletonCap().StopTracking(userIds[i]);
-        }
-        if(userGenerator.GetSkeletonCap().IsCalibrated(userIds[i])) {
-            userGenerator.GetSkeletonCap().Reset(userIds[i]);
-        }
-        userGenerator.GetPoseDetectionCap().StartPoseDetection(CALIBRATION_POSE, userIds[i]);
-    }
-    if(userGenerator.GetSkeletonCap().IsCalibrationData(CALIBRATION_SLOT)) {
-        userGenerator.GetSkeletonCap().ClearCalibrationData(CALIBRATION_SLOT);
-    }
+    PushCommand(SC_TurnOff);
+    calibrationData = false;
     state = Off;
-    stateMutex.unlock();
 }
 
 void SensorsModule::BeginCalibration() {
-    stateMutex.lock();
     state = Calibrating;
-    stateMutex.unlock();
 }
 
 void SensorsModule::ResetCalibration() {
-    stateMutex.lock();
-    userGenerator.GetSkeletonCap().ClearCalibrationData(CALIBRATION_SLOT);
-    stateMutex.unlock();
+    PushCommand(SC_ClearCalibration);
+    calibrationData = false;
 }
 
 void SensorsModule::Work() {
-    stateMutex.lock();
-    XnUInt16 numberOfUsers = userGenerator.GetNumberOfUsers();
-    XnUserID userIds[numberOfUsers];
-    userGenerator.GetUsers(userIds, numberOfUsers);
-    for(int i=0; i < numberOfUsers; ++i) {
-        if(userGenerator.GetSkeletonCap().IsCalibrating(userIds[i])) {
-            userGenerator.GetSkeletonCap().AbortCalibration(userIds[i]);
-        }
-        if(!userGenerator.GetSkeletonCap().IsCalibrated(userIds[i])) {
-            userGenerator.GetSkeletonCap().LoadCalibrationData(userIds[i], CALIBRATION_SLOT);
-        }
-        if(!userGenerator.GetSkeletonCap().IsTracking(userIds[i])) {
-            userGenerator.GetSkeletonCap().StartTracking(userIds[i]);
-        }
-    }
+    PushCommand(SC_Work);
     state = Working;
-    stateMutex.unlock();
+}
+
+void SensorsModule::PushEvent(SensorEventType type, XnUserID userId, XnCalibrationStatus calibrationStatus) {
+    SensorEvent event;
+    event.type = type;
+    event.userId = userId;
+    event.calibrationStatus = calibrationStatus;
+    event.time = DiagnosticsModule::Now();
+    event.threadId = captureThreadRunning ? TT_Sensor : TT_Control;
+    if(!eventQueue.Push(event)) {
+        ++droppedEvents;
+    }
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
-//Callbacks
+//Private
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
-void SensorsModule::User_NewUser(xn::UserGenerator& generator, XnUserID userId, void* cookie) {
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- new", userId);
-    }
-    if (SensorsModule::GetInstance().GetState() != Off) {
-        if(SensorsModule::GetInstance().GetState() == Working) {
-            if(generator.GetSkeletonCap().IsCalibrationData(CALIBRATION_SLOT)) {
-                generator.GetSkeletonCap().LoadCalibrationData(userId, CALIBRATION_SLOT);
-                generator.GetSkeletonCap().StartTracking(userId);
-                if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-                    ROS_DEBUG("SensorsModule: User: %d- loaded calibration data, tracking", userId);
-                }
-            }
-            else {
-                if(SensorsModule::GetInstance().GetLogLevel() <= Error) {
-                    ROS_ERROR("SensorsModule: User: %d- missing calibration data", userId);
-                }
-            }
-        }
-        generator.GetPoseDetectionCap().StartPoseDetection(CALIBRATION_POSE, userId);
+void SensorsModule::Capture() {
+    std::shared_ptr<SkeletonFrame> frame = AcquireFreeFrame();
+    frame->Clear();
+    //Source is used only here while capture thread runs, commands queued during last frame go in before waiting for next one
+    ApplyCommands();
+    source->WaitForUpdate();
+    frame->captureStart = DiagnosticsModule::Now();
+    frame->frameId = ++capturedFrames;
+    source->FillFrame(*frame);
+    if(jointSmoothing && !source->IsSmoothed()) {
+        SmoothJoints(*frame);
     }
-    DataStorage::GetInstance().UserNew(userId);
-    SensorsModule::GetInstance().UnlockStateMutex();
+    frame->captureEnd = DiagnosticsModule::Now();
+    frameMutex.lock();
+    latestFrame = frame;
+    frameMutex.unlock();
+    frameCondition.notify_one();
 }
 
-void SensorsModule::User_Exit(xn::UserGenerator &generator, XnUserID userId, void *cookie) {
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- exit", userId);
+void SensorsModule::SmoothJoints(SkeletonFrame& frame) {
+    double timeStep = frame.timestamp - lastSmoothingTimestamp;
+    lastSmoothingTimestamp = frame.timestamp;
+    if(timeStep <= 0.0) {
+        timeStep = JOINT_SMOOTHING_DEFAULT_TIME_STEP;
+    }
+    //Joints of users that are not tracked and joints without confidence restart their filters
+    for(int user=0; user < frame.maxUsers; ++user) {
+        float tracked = frame.userTracked[user] ? 1.0f : 0.0f;
+        float const* confidence = &frame.jointConfidence[user*SKELETON_FRAME_JOINTS];
+        float* active = &jointActive[user*SKELETON_FRAME_JOINTS];
+        for(int joint=0; joint < SKELETON_FRAME_JOINTS; ++joint) {
+            active[joint] = confidence[joint] > 0.0f ? tracked : 0.0f;
+        }
     }
-    DataStorage::GetInstance().UserExit(userId);
-    SensorsModule::GetInstance().UnlockStateMutex();
+    jointFilters[0].Filter(frame.jointX.data(), jointActive.data(), timeStep);
+    jointFilters[1].Filter(frame.jointY.data(), jointActive.data(), timeStep);
+    jointFilters[2].Filter(frame.jointZ.data(), jointActive.data(), timeStep);
 }
 
-void SensorsModule::User_ReEnter(xn::UserGenerator &generator, XnUserID userId, void *cookie)
-{
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- reenter", userId);
+bool SensorsModule::ReadJointSmoothing(ros::NodeHandle* nodeHandlePrivate) {
+    double minCutoff;
+    double beta;
+    double derivativeCutoff;
+    if(!nodeHandlePrivate->getParam("jointSmoothing", jointSmoothing)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of jointSmoothing not found, using default: %d", DEFAULT_JOINT_SMOOTHING);
+        }
+        jointSmoothing = DEFAULT_JOINT_SMOOTHING;
+    }
+    if(!nodeHandlePrivate->getParam("jointSmoothingMinCutoff", minCutoff)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of jointSmoothingMinCutoff not found, using default: %f", DEFAULT_JOINT_SMOOTHING_MIN_CUTOFF);
+        }
+        minCutoff = DEFAULT_JOINT_SMOOTHING_MIN_CUTOFF;
     }
-    DataStorage::GetInstance().UserReEnter(userId);
-    SensorsModule::GetInstance().UnlockStateMutex();
+    if(!nodeHandlePrivate->getParam("jointSmoothingBeta", beta)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of jointSmoothingBeta not found, using default: %f", DEFAULT_JOINT_SMOOTHING_BETA);
+        }
+        beta = DEFAULT_JOINT_SMOOTHING_BETA;
+    }
+    if(!nodeHandlePrivate->getParam("jointSmoothingDerivativeCutoff", derivativeCutoff)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of jointSmoothingDerivativeCutoff not found, using default: %f", DEFAULT_JOINT_SMOOTHING_DERIVATIVE_CUTOFF);
+        }
+        derivativeCutoff = DEFAULT_JOINT_SMOOTHING_DERIVATIVE_CUTOFF;
+    }
+    if(minCutoff <= 0.0 || beta < 0.0 || derivativeCutoff <= 0.0) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Joint smoothing cutoffs must be positive and beta not negative");
+        }
+        return false;
+    }
+    int size = DataStorage::GetInstance().GetMaxUsers()*SKELETON_FRAME_JOINTS;
+    for(int i=0; i < 3; ++i) {
+        jointFilters[i].Resize(size);
+        jointFilters[i].SetParameters(minCutoff, beta, derivativeCutoff);
+    }
+    jointActive.assign(size, 0.0f);
+    lastSmoothingTimestamp = 0.0;
+    return true;
 }
 
-void SensorsModule::User_LostUser(xn::UserGenerator& generator, XnUserID userId, void* cookie)
-{
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- lost", userId);
+std::shared_ptr<SkeletonFrame> SensorsModule::AcquireFreeFrame() {
+    //Frame held only by the pool is referenced neither as latest nor as current one
+    frameMutex.lock();
+    std::shared_ptr<SkeletonFrame> freeFrame;
+    for(int i=0; i < framePool.size(); ++i) {
+        if(framePool[i].use_count() == 1) {
+            freeFrame = framePool[i];
+            break;
+        }
+    }
+    frameMutex.unlock();
+    if(!freeFrame) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Frame pool exhausted, allocating new frame");
+        }
+        freeFrame = std::make_shared<SkeletonFrame>();
+        freeFrame->Resize(DataStorage::GetInstance().GetMaxUsers());
     }
-    SensorsModule::GetInstance().UnlockStateMutex();
+    return freeFrame;
 }
 
-void SensorsModule::UserPose_PoseDetected(xn::PoseDetectionCapability& capability, XnChar const* strPose, XnUserID userId, void* pCookie)
-{
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- pose detected", userId);
+void SensorsModule::CaptureThreadLoop() {
+    while(captureThreadRunning) {
+        Capture();
     }
-    if(SensorsModule::GetInstance().GetState() == Calibrating) {
-        if(DataStorage::GetInstance().IsPoseCooldownPassed(userId-1)) {
-            SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().RequestCalibration(userId, TRUE);
+}
+
+void SensorsModule::PushCommand(SensorCommandType type, XnUserID userId) {
+    SensorCommand command;
+    command.type = type;
+    command.userId = userId;
+    if(!commandQueue.Push(command)) {
+        ++droppedCommands;
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Command queue full, dropped command %d for user: %d", type, userId);
         }
     }
-    DataStorage::GetInstance().UserPose(userId - 1);
-    SensorsModule::GetInstance().UnlockStateMutex();
 }
 
-void SensorsModule::UserCalibration_CalibrationStart(xn::SkeletonCapability& skeleton, XnUserID userId, void* cookie)
-{
-    SensorsModule::GetInstance().LockStateMutex();
-    if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-        ROS_DEBUG("SensorsModule: User: %d- calibration start", userId);
+void SensorsModule::ApplyCommands() {
+    SensorCommand command;
+    while(commandQueue.Pop(command)) {
+        ApplyCommand(command);
     }
-    SensorsModule::GetInstance().UnlockStateMutex();
 }
 
-void SensorsModule::UserCalibration_CalibrationComplete(xn::SkeletonCapability& skeleton, XnUserID userId, XnCalibrationStatus calibrationError, void* pCookie)
-{
-    SensorsModule::GetInstance().LockStateMutex();
-    if(calibrationError == XN_CALIBRATION_STATUS_OK) {
-        if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-            ROS_DEBUG("SensorsModule: User: %d- calibration successful", userId);
-        }
-        if(SensorsModule::GetInstance().GetState() == Calibrating && !SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().IsCalibrationData(CALIBRATION_SLOT)) {
-            SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().SaveCalibrationData(userId, CALIBRATION_SLOT);
-            SensorsModule::GetInstance().GetUserGenerator().GetSkeletonCap().StartTracking(userId);
-            DataStorage::GetInstance().SetCurrentUserXnId(userId);
-            if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-                ROS_DEBUG("SensorsModule: User: %d- saved calibration data", userId);
+void SensorsModule::ApplyCommand(SensorCommand const& command) {
+    XnUserID userId = command.userId;
+    switch (command.type) {
+        case SC_TurnOff:
+            source->GetUsers(users);
+            for(int i=0; i < users.size(); ++i) {
+                if(source->IsCalibrating(users[i])) {
+                    source->AbortCalibration(users[i]);
+                }
+                if(source->IsTracking(users[i])) {
+                    source->StopTracking(users[i]);
+                }
+                if(source->IsCalibrated(users[i])) {
+                    source->ResetCalibration(users[i]);
+                }
+                source->StartPoseDetection(users[i]);
             }
-        }
+            if(source->IsCalibrationData()) {
+                source->ClearCalibrationData();
+            }
+            break;
+        case SC_ClearCalibration:
+            source->ClearCalibrationData();
+            break;
+        case SC_Work:
+            source->GetUsers(users);
+            for(int i=0; i < users.size(); ++i) {
+                if(source->IsCalibrating(users[i])) {
+                    source->AbortCalibration(users[i]);
+                }
+                if(!source->IsCalibrated(users[i])) {
+                    source->LoadCalibrationData(users[i]);
+                }
+                if(!source->IsTracking(users[i])) {
+                    source->StartTracking(users[i]);
+                }
+            }
+            break;
+        case SC_LoadCalibration:
+            source->LoadCalibrationData(userId);
+            source->StartTracking(userId);
+            break;
+        case SC_SaveCalibration:
+            source->SaveCalibrationData(userId);
+            source->StartTracking(userId);
+            break;
+        case SC_RequestCalibration:
+            source->RequestCalibration(userId);
+            break;
+        case SC_StartPoseDetection:
+            source->StartPoseDetection(userId);
+            break;
+        default:
+            break;
     }
-    else {
-        if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
-            ROS_DEBUG("SensorsModule: User: %d- calibration failed", userId);
+}
+
+void SensorsModule::ProcessEvents() {
+    if(eventQueue.Size() == 0) {
+        return;
+    }
+    SensorEvent event;
+    DiagnosticsModule& diagnostics = DiagnosticsModule::GetInstance();
+    bool tracing = diagnostics.IsTracing();
+    while(eventQueue.Pop(event)) {
+        ++eventCounts[event.type];
+        processedEvents.push_back(event);
+        if(tracing) {
+            diagnostics.TraceInstant(eventNames[event.type], "sensor_event", event.time, event.threadId, event.userId);
         }
+        ProcessEvent(event);
+    }
+}
+
+void SensorsModule::ProcessEvent(SensorEvent const& event) {
+    XnUserID userId = event.userId;
+    switch (event.type) {
+        case SE_NewUser:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- new", userId);
+            }
+            if (state != Off) {
+                if(state == Working) {
+                    if(calibrationData) {
+                        PushCommand(SC_LoadCalibration, userId);
+                        if(logLevel <= Debug) {
+                            ROS_DEBUG("SensorsModule: User: %d- loaded calibration data, tracking", userId);
+                        }
+                    }
+                    else {
+                        if(logLevel <= Error) {
+                            ROS_ERROR("SensorsModule: User: %d- missing calibration data", userId);
+                        }
+                    }
+                }
+                PushCommand(SC_StartPoseDetection, userId);
+            }
+            DataStorage::GetInstance().UserNew(userId);
+            break;
+        case SE_UserExit:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- exit", userId);
+            }
+            DataStorage::GetInstance().UserExit(userId);
+            break;
+        case SE_UserReEnter:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- reenter", userId);
+            }
+            DataStorage::GetInstance().UserReEnter(userId);
+            break;
+        case SE_LostUser:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- lost", userId);
+            }
+            break;
+        case SE_PoseDetected:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- pose detected", userId);
+            }
+            if(state == Calibrating) {
+                if(DataStorage::GetInstance().IsPoseCooldownPassed(userId)) {
+                    PushCommand(SC_RequestCalibration, userId);
+                }
+            }
+            DataStorage::GetInstance().UserPose(userId);
+            break;
+        case SE_CalibrationStart:
+            if(logLevel <= Debug) {
+                ROS_DEBUG("SensorsModule: User: %d- calibration start", userId);
+            }
+            break;
+        case SE_CalibrationComplete:
+            if(event.calibrationStatus == XN_CALIBRATION_STATUS_OK) {
+                if(logLevel <= Debug) {
+                    ROS_DEBUG("SensorsModule: User: %d- calibration successful", userId);
+                }
+                if(state == Calibrating && !calibrationData) {
+                    PushCommand(SC_SaveCalibration, userId);
+                    calibrationData = true;
+                    DataStorage::GetInstance().SetCurrentUserXnId(userId);
+                    if(logLevel <= Debug) {
+                        ROS_DEBUG("SensorsModule: User: %d- saved calibration data", userId);
+                    }
+                }
+            }
+            else {
+                if(logLevel <= Debug) {
+                    ROS_DEBUG("SensorsModule: User: %d- calibration failed", userId);
+                }
+            }
+            PushCommand(SC_StartPoseDetection, userId);
+            break;
+        default:
+            break;
     }
-    SensorsModule::GetInstance().GetUserGenerator().GetPoseDetectionCap().StartPoseDetection(CALIBRATION_POSE, userId);
-    SensorsModule::GetInstance().UnlockStateMutex();
 }
@@ -5,8 +5,26 @@
 #define CALIBRATION_POSE "Psi"
 #define CALIBRATION_SLOT 0
 #define SMOOTHING_FACTOR 0.0f
+#define FRAME_POOL_SIZE 3
+#define EVENT_QUEUE_CAPACITY 256
+#define COMMAND_QUEUE_CAPACITY 1024
+#define DEFAULT_SENSOR_SOURCE "openni"
+#define DEFAULT_COLOR_APPEARANCE false
+#define COLOR_HISTOGRAM_STEP 2
+#define DEFAULT_USER_SILHOUETTES true
+#define DEFAULT_FLOOR_PLANE true
+#define DEFAULT_JOINT_SMOOTHING true
+#define DEFAULT_JOINT_SMOOTHING_MIN_CUTOFF 1.0
+#define DEFAULT_JOINT_SMOOTHING_BETA 0.007
+#define DEFAULT_JOINT_SMOOTHING_DERIVATIVE_CUTOFF 1.0
+#define JOINT_SMOOTHING_DEFAULT_TIME_STEP (1.0/30.0)
 
 #include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <string>
 #include <ros/ros.h>
 #include <ros/package.h>
 #include <XnOpenNI.h>
@@ -14,12 +32,41 @@
 #include <XnCppWrapper.h>
 #include "../Common.h"
 #include "DataStorage.h"
+#include "SkeletonFrame.h"
+#include "../Utilities/SPSC_Queue.h"
+#include "../Utilities/OneEuroFilter.h"
+#include "SkeletonSources/Skeleton_Source.h"
 
 
 enum SensorsState {
     Off, Calibrating, Working
 };
 
+enum SensorEventType {
+    SE_NewUser, SE_UserExit, SE_UserReEnter, SE_LostUser, SE_PoseDetected, SE_CalibrationStart, SE_CalibrationComplete,
+    SE_NUMBER_OF_TYPES
+};
+
+//Requests to the source made by control thread, applied by capture side between frames so that
+//control thread never touches source while capture thread waits for sensor
+enum SensorCommandType {
+    SC_TurnOff, SC_ClearCalibration, SC_Work, SC_LoadCalibration, SC_SaveCalibration, SC_RequestCalibration,
+    SC_StartPoseDetection
+};
+
+struct SensorCommand {
+    SensorCommandType type;
+    XnUserID userId;
+};
+
+struct SensorEvent {
+    SensorEventType type;
+    XnUserID userId;
+    XnCalibrationStatus calibrationStatus;
+    double time;
+    int threadId;
+};
+
 class SensorsModule {
 public:
     static SensorsModule& GetInstance() {
@@ -29,39 +76,76 @@ public:
     bool Initialize(ros::NodeHandle* nodeHandlePrivate);
     void Update();
     void Finish();
+    void StartCaptureThread();
+    void StopCaptureThread();
+    bool IsCaptureThreadRunning();
+    bool IsLive();
+    bool IsEndOfRecording();
+    bool IsNewFrame();
+    void WaitForFrame(double timeout);
+    const SkeletonFrame& GetFrame();
     LogLevels GetLogLevel();
-    xn::UserGenerator GetUserGenerator();
-    void LockStateMutex();
-    void UnlockStateMutex();
+    bool IsColorEnabled();
+    bool IsSilhouettesEnabled();
+    bool IsFloorEnabled();
+    bool IsJointSmoothed();
+    //Source is driven by capture thread when it runs, so it may be inspected only while it does not
+    Skeleton_Source* GetSource();
+    std::vector<SensorEvent> const& GetProcessedEvents();
     SensorsState GetState();
+    unsigned long GetEventCount(SensorEventType type);
+    unsigned long GetDroppedEventsCount();
     void TurnSensorOff();
     void BeginCalibration();
     void ResetCalibration();
     void Work();
+    void PushEvent(SensorEventType type, XnUserID userId, XnCalibrationStatus calibrationStatus = XN_CALIBRATION_STATUS_OK);
 
 private:
     LogLevels logLevel;
-    std::mutex stateMutex;
-    xn::Context context;
-    xn::UserGenerator userGenerator;
+    std::string sensorSource;
+    bool colorEnabled;
+    bool silhouettesEnabled;
+    bool floorEnabled;
+    bool jointSmoothing;
+    //Filter state is laid out like joints of SkeletonFrame, one filter bank per axis
+    OneEuroFilter jointFilters[3];
+    std::vector<float> jointActive;
+    double lastSmoothingTimestamp;
+    Skeleton_Source* source = NULL;
+    std::mutex frameMutex;
+    std::condition_variable frameCondition;
+    bool newFrame;
+    std::thread captureThread;
+    std::atomic<bool> captureThreadRunning;
+    std::vector<std::shared_ptr<SkeletonFrame>> framePool;
+    std::vector<XnUserID> users;
+    std::shared_ptr<const SkeletonFrame> latestFrame;
+    std::shared_ptr<const SkeletonFrame> currentFrame;
+    unsigned long capturedFrames;
+    SPSC_Queue<SensorEvent> eventQueue;
+    SPSC_Queue<SensorCommand> commandQueue;
+    std::atomic<unsigned long> droppedCommands;
+    bool calibrationData;
+    std::vector<SensorEvent> processedEvents;
+    unsigned long eventCounts[SE_NUMBER_OF_TYPES];
+    std::atomic<unsigned long> droppedEvents;
     SensorsState state;
-    XnCallbackHandle userCallbacksHandle;
-    XnCallbackHandle calibrationCallbacksHandle;
-    XnCallbackHandle poseCallbacksHandle;
 
-    SensorsModule() {}
+    SensorsModule() : newFrame(false), captureThreadRunning(false), droppedCommands(0), droppedEvents(0) {}
     SensorsModule(const SensorsModule &);
     SensorsModule& operator=(const SensorsModule&);
     ~SensorsModule() {}
-
-    //Callbacks
-    static void User_NewUser(xn::UserGenerator& generator, XnUserID userId, void* cookie);
-    static void User_Exit(xn::UserGenerator& generator, XnUserID userId, void* cookie);
-    static void User_ReEnter(xn::UserGenerator& generator, XnUserID userId, void* cookie);
-    static void User_LostUser(xn::UserGenerator& generator, XnUserID userId, void* cookie);
-    static void UserPose_PoseDetected(xn::PoseDetectionCapability& capability, XnChar const* strPose, XnUserID userId, void* pCookie);
-    static void UserCalibration_CalibrationStart(xn::SkeletonCapability& capability, XnUserID userId, void* cookie);
-    static void UserCalibration_CalibrationComplete(xn::SkeletonCapability& skeleton, XnUserID userId, XnCalibrationStatus calibrationError, void* pCookie);
+    void Capture();
+    void SmoothJoints(SkeletonFrame& frame);
+    bool ReadJointSmoothing(ros::NodeHandle* nodeHandlePrivate);
+    std::shared_ptr<SkeletonFrame> AcquireFreeFrame();
+    void CaptureThreadLoop();
+    void PushCommand(SensorCommandType type, XnUserID userId = 0);
+    void ApplyCommands();
+    void ApplyCommand(SensorCommand const& command);
+    void ProcessEvents();
+    void ProcessEvent(SensorEvent const& event);
 };
 
 #endif //ELEKTRON_ESCORT_SENSORS_MODULE_H
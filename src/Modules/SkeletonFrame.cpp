@@ -0,0 +1,111 @@
+#include "SkeletonFrame.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SkeletonFrame::Resize(int newMaxUsers) {
+    maxUsers = newMaxUsers;
+    users.reserve(maxUsers);
+    userPresent.resize(maxUsers);
+    userTracked.resize(maxUsers);
+    userCoM.resize(maxUsers);
+    jointX.resize(maxUsers*SKELETON_FRAME_JOINTS);
+    jointY.resize(maxUsers*SKELETON_FRAME_JOINTS);
+    jointZ.resize(maxUsers*SKELETON_FRAME_JOINTS);
+    jointConfidence.resize(maxUsers*SKELETON_FRAME_JOINTS);
+    std::fill(jointX.begin(), jointX.end(), 0.0f);
+    std::fill(jointY.begin(), jointY.end(), 0.0f);
+    std::fill(jointZ.begin(), jointZ.end(), 0.0f);
+    std::fill(jointConfidence.begin(), jointConfidence.end(), 0.0f);
+    colorHistograms.assign(maxUsers*COLOR_HISTOGRAM_REGIONS*COLOR_HISTOGRAM_BINS, 0.0f);
+    silhouettes.resize(maxUsers);
+    Clear();
+}
+
+void SkeletonFrame::Clear() {
+    //Joints of users that are not tracked are never read, so only flags need resetting
+    users.clear();
+    std::fill(userPresent.begin(), userPresent.end(), false);
+    std::fill(userTracked.begin(), userTracked.end(), false);
+    colorAvailable = false;
+    silhouettesAvailable = false;
+    floorAvailable = false;
+}
+
+bool SkeletonFrame::IsValidUser(XnUserID userId) const {
+    return userId >= 1 && userId <= maxUsers;
+}
+
+bool SkeletonFrame::IsUserPresent(XnUserID userId) const {
+    return IsValidUser(userId) && userPresent[userId-1];
+}
+
+bool SkeletonFrame::IsUserTracked(XnUserID userId) const {
+    return IsValidUser(userId) && userTracked[userId-1];
+}
+
+XnPoint3D SkeletonFrame::GetCoM(XnUserID userId) const {
+    if(IsUserPresent(userId)) {
+        return userCoM[userId-1];
+    }
+    XnPoint3D zero;
+    zero.X = 0.0f;
+    zero.Y = 0.0f;
+    zero.Z = 0.0f;
+    return zero;
+}
+
+XnSkeletonJointPosition SkeletonFrame::GetJoint(XnUserID userId, XnSkeletonJoint joint) const {
+    XnSkeletonJointPosition position;
+    if(IsUserTracked(userId)) {
+        int index = JointIndex(userId, joint);
+        position.position.X = jointX[index];
+        position.position.Y = jointY[index];
+        position.position.Z = jointZ[index];
+        position.fConfidence = jointConfidence[index];
+    }
+    else {
+        position.position.X = 0.0f;
+        position.position.Y = 0.0f;
+        position.position.Z = 0.0f;
+        position.fConfidence = 0.0f;
+    }
+    return position;
+}
+
+void SkeletonFrame::SetJoint(XnUserID userId, XnSkeletonJoint joint, XnSkeletonJointPosition const& position) {
+    int index = JointIndex(userId, joint);
+    jointX[index] = position.position.X;
+    jointY[index] = position.position.Y;
+    jointZ[index] = position.position.Z;
+    jointConfidence[index] = position.fConfidence;
+}
+
+float const* SkeletonFrame::GetColorHistogram(XnUserID userId, ColorRegions region) const {
+    if(!colorAvailable || !IsUserPresent(userId)) {
+        return NULL;
+    }
+    return &colorHistograms[((userId-1)*COLOR_HISTOGRAM_REGIONS + region)*COLOR_HISTOGRAM_BINS];
+}
+
+float* SkeletonFrame::GetColorHistogram(XnUserID userId, ColorRegions region) {
+    return &colorHistograms[((userId-1)*COLOR_HISTOGRAM_REGIONS + region)*COLOR_HISTOGRAM_BINS];
+}
+
+UserSilhouette const* SkeletonFrame::GetSilhouette(XnUserID userId) const {
+    if(!silhouettesAvailable || !IsUserPresent(userId) || silhouettes[userId-1].pixels == 0) {
+        return NULL;
+    }
+    return &silhouettes[userId-1];
+}
+
+double SkeletonFrame::GetHeightAboveFloor(XnPoint3D const& point) const {
+    //Signed distance to floor plane, normal points up
+    XnVector3D const& normal = floor.vNormal;
+    double length = sqrt(normal.X*normal.X + normal.Y*normal.Y + normal.Z*normal.Z);
+    if(!floorAvailable || length <= 0.0) {
+        return 0.0;
+    }
+    return (normal.X*(point.X - floor.ptPoint.X) + normal.Y*(point.Y - floor.ptPoint.Y) + normal.Z*(point.Z - floor.ptPoint.Z))/length;
+}
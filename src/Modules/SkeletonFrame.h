@@ -0,0 +1,73 @@
+#ifndef ELEKTRON_ESCORT_SKELETON_FRAME_H
+#define ELEKTRON_ESCORT_SKELETON_FRAME_H
+
+#define SKELETON_FRAME_JOINTS 24
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <XnCppWrapper.h>
+#include "../Common.h"
+#include "../Utilities/LabelColorHistogram.h"
+
+
+//Immutable copy of everything modules read from the sensor during one tick.
+//Per-user data is indexed by userId-1, joints are stored as struct-of-arrays
+//with SKELETON_FRAME_JOINTS consecutive entries per user. Color histograms are filled only
+//when source captures image, COLOR_HISTOGRAM_REGIONS*COLOR_HISTOGRAM_BINS entries per user.
+//Silhouettes are filled only when source reduces user mask over depth map, floor only when source knows it.
+
+//User mask statistics, box in depth map pixels, depths and height in mm, center and crown (top of mask) in real world coordinates
+struct UserSilhouette {
+    unsigned int pixels;
+    int left;
+    int top;
+    int right;
+    int bottom;
+    float meanDepth;
+    float minDepth;
+    float maxDepth;
+    float height;
+    XnPoint3D center;
+    XnPoint3D crown;
+};
+
+struct SkeletonFrame {
+    unsigned long frameId = 0;
+    double timestamp = 0.0;
+    double captureStart = 0.0;
+    double captureEnd = 0.0;
+    int maxUsers = 0;
+    std::vector<XnUserID> users;
+    std::vector<bool> userPresent;
+    std::vector<bool> userTracked;
+    std::vector<XnPoint3D> userCoM;
+    std::vector<float> jointX;
+    std::vector<float> jointY;
+    std::vector<float> jointZ;
+    std::vector<float> jointConfidence;
+    bool colorAvailable = false;
+    std::vector<float> colorHistograms;
+    bool silhouettesAvailable = false;
+    std::vector<UserSilhouette> silhouettes;
+    bool floorAvailable = false;
+    XnPlane3D floor;
+
+    void Resize(int newMaxUsers);
+    void Clear();
+    bool IsValidUser(XnUserID userId) const;
+    bool IsUserPresent(XnUserID userId) const;
+    bool IsUserTracked(XnUserID userId) const;
+    XnPoint3D GetCoM(XnUserID userId) const;
+    XnSkeletonJointPosition GetJoint(XnUserID userId, XnSkeletonJoint joint) const;
+    void SetJoint(XnUserID userId, XnSkeletonJoint joint, XnSkeletonJointPosition const& position);
+    float const* GetColorHistogram(XnUserID userId, ColorRegions region) const;
+    float* GetColorHistogram(XnUserID userId, ColorRegions region);
+    UserSilhouette const* GetSilhouette(XnUserID userId) const;
+    double GetHeightAboveFloor(XnPoint3D const& point) const;
+    static int JointIndex(XnUserID userId, XnSkeletonJoint joint) {
+        return (userId-1)*SKELETON_FRAME_JOINTS + (joint-1);
+    }
+};
+
+#endif //ELEKTRON_ESCORT_SKELETON_FRAME_H
@@ -0,0 +1,413 @@
+#include "SkeletonLog.h"
+#include <cstring>
+#include <chrono>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SkeletonLogWriter::Start(std::string const& fileName, int maxUsers, bool smoothed, bool _lossless) {
+    if(running) {
+        return true;
+    }
+    //Record of frame with every user tracked must fit into single block
+    size_t maxRecordSize = sizeof(SkeletonLogFrameRecord) + SKELETON_LOG_MAX_EVENTS*sizeof(SkeletonLogEventRecord) +
+            maxUsers*(sizeof(SkeletonLogUserRecord) + sizeof(UserSilhouette) + SKELETON_FRAME_JOINTS*sizeof(SkeletonLogJoint));
+    if(maxRecordSize > SKELETON_LOG_BLOCK_SIZE - sizeof(SkeletonLogBlockHeader)) {
+        return false;
+    }
+    file = fopen(fileName.c_str(), "wb");
+    if(file == NULL) {
+        return false;
+    }
+    SkeletonLogHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = SKELETON_LOG_MAGIC;
+    header.version = SKELETON_LOG_VERSION;
+    header.blockSize = SKELETON_LOG_BLOCK_SIZE;
+    header.maxUsers = maxUsers;
+    header.joints = SKELETON_FRAME_JOINTS;
+    header.flags = smoothed ? SKELETON_LOG_SMOOTHED : 0u;
+    if(fwrite(&header, sizeof(header), 1, file) != 1) {
+        fclose(file);
+        file = NULL;
+        return false;
+    }
+    jointMasks.reserve(maxUsers);
+    blocks.clear();
+    for(int i=0; i < SKELETON_LOG_QUEUE_BLOCKS; ++i) {
+        blocks.push_back(std::unique_ptr<char[]>(new char[SKELETON_LOG_BLOCK_SIZE]));
+    }
+    freeBlocks.Reserve(SKELETON_LOG_QUEUE_BLOCKS);
+    fullBlocks.Reserve(SKELETON_LOG_QUEUE_BLOCKS);
+    for(int i=1; i < SKELETON_LOG_QUEUE_BLOCKS; ++i) {
+        freeBlocks.Push(i);
+    }
+    lossless = _lossless;
+    currentBlock = 0;
+    currentUsed = sizeof(SkeletonLogBlockHeader);
+    writtenFrames = 0;
+    droppedFrames = 0;
+    running = true;
+    writerThread = std::thread(&SkeletonLogWriter::WriterThreadLoop, this);
+    return true;
+}
+
+void SkeletonLogWriter::Stop() {
+    if(!running) {
+        return;
+    }
+    if(currentBlock >= 0 && currentUsed > sizeof(SkeletonLogBlockHeader)) {
+        SealBlock();
+    }
+    running = false;
+    wakeCondition.notify_one();
+    if(writerThread.joinable()) {
+        writerThread.join();
+    }
+    Flush();
+    fclose(file);
+    file = NULL;
+}
+
+bool SkeletonLogWriter::IsRunning() {
+    return running;
+}
+
+unsigned long SkeletonLogWriter::GetWrittenFramesCount() {
+    return writtenFrames;
+}
+
+unsigned long SkeletonLogWriter::GetDroppedFramesCount() {
+    return droppedFrames;
+}
+
+void SkeletonLogWriter::Append(SkeletonFrame const& frame, std::vector<SensorEvent> const& events,
+                               float linearVelocity, float angularVelocity) {
+    if(!running) {
+        return;
+    }
+    //Only confident joints of tracked users are stored, the rest reads back with zero confidence
+    int numberOfEvents = std::min((int)events.size(), SKELETON_LOG_MAX_EVENTS);
+    size_t userSize = sizeof(SkeletonLogUserRecord) + (frame.silhouettesAvailable ? sizeof(UserSilhouette) : 0);
+    size_t recordSize = sizeof(SkeletonLogFrameRecord) + numberOfEvents*sizeof(SkeletonLogEventRecord);
+    jointMasks.clear();
+    for(int i=0; i < frame.users.size(); ++i) {
+        XnUserID userId = frame.users[i];
+        uint32_t mask = 0;
+        if(frame.IsUserTracked(userId)) {
+            float const* confidence = &frame.jointConfidence[SkeletonFrame::JointIndex(userId, XN_SKEL_HEAD)];
+            for(int joint=0; joint < SKELETON_FRAME_JOINTS; ++joint) {
+                if(confidence[joint] > 0.0f) {
+                    mask |= 1u << joint;
+                }
+            }
+        }
+        jointMasks.push_back(mask);
+        recordSize += userSize + __builtin_popcount(mask)*sizeof(SkeletonLogJoint);
+    }
+    if(currentBlock >= 0 && currentUsed + recordSize > SKELETON_LOG_BLOCK_SIZE) {
+        SealBlock();
+    }
+    if(currentBlock < 0) {
+        while(!freeBlocks.Pop(currentBlock)) {
+            if(!lossless) {
+                currentBlock = -1;
+                ++droppedFrames;
+                return;
+            }
+            std::this_thread::yield();
+        }
+        currentUsed = sizeof(SkeletonLogBlockHeader);
+    }
+    char* destination = blocks[currentBlock].get() + currentUsed;
+    SkeletonLogFrameRecord record;
+    memset(&record, 0, sizeof(record));
+    record.timestamp = frame.timestamp;
+    record.frameId = frame.frameId;
+    record.linearVelocity = linearVelocity;
+    record.angularVelocity = angularVelocity;
+    record.users = frame.users.size();
+    record.events = numberOfEvents;
+    record.silhouettesAvailable = frame.silhouettesAvailable;
+    record.floorAvailable = frame.floorAvailable;
+    record.floor = frame.floor;
+    memcpy(destination, &record, sizeof(record));
+    destination += sizeof(record);
+    for(int i=0; i < frame.users.size(); ++i) {
+        XnUserID userId = frame.users[i];
+        SkeletonLogUserRecord user;
+        memset(&user, 0, sizeof(user));
+        user.userId = userId;
+        user.jointMask = jointMasks[i];
+        user.com = frame.GetCoM(userId);
+        user.tracked = frame.IsUserTracked(userId);
+        memcpy(destination, &user, sizeof(user));
+        destination += sizeof(user);
+        if(frame.silhouettesAvailable) {
+            memcpy(destination, &frame.silhouettes[userId-1], sizeof(UserSilhouette));
+            destination += sizeof(UserSilhouette);
+        }
+        int index = SkeletonFrame::JointIndex(userId, XN_SKEL_HEAD);
+        for(int joint=0; joint < SKELETON_FRAME_JOINTS; ++joint) {
+            if(user.jointMask & (1u << joint)) {
+                SkeletonLogJoint position;
+                position.x = frame.jointX[index + joint];
+                position.y = frame.jointY[index + joint];
+                position.z = frame.jointZ[index + joint];
+                position.confidence = frame.jointConfidence[index + joint];
+                memcpy(destination, &position, sizeof(position));
+                destination += sizeof(position);
+            }
+        }
+    }
+    for(int i=0; i < numberOfEvents; ++i) {
+        SkeletonLogEventRecord event;
+        event.type = events[i].type;
+        event.userId = events[i].userId;
+        event.calibrationStatus = events[i].calibrationStatus;
+        memcpy(destination, &event, sizeof(event));
+        destination += sizeof(event);
+    }
+    currentUsed += recordSize;
+    ++writtenFrames;
+}
+
+SkeletonLogReader::~SkeletonLogReader() {
+    Close();
+}
+
+bool SkeletonLogReader::Open(std::string const& fileName) {
+    Close();
+    int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0) {
+        return false;
+    }
+    struct stat fileStat;
+    if(fstat(fd, &fileStat) != 0 || fileStat.st_size < sizeof(SkeletonLogHeader)) {
+        close(fd);
+        return false;
+    }
+    size = fileStat.st_size;
+    void* mapping = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = static_cast<char const*>(mapping);
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != SKELETON_LOG_MAGIC || header.version != SKELETON_LOG_VERSION ||
+       header.joints != SKELETON_FRAME_JOINTS || header.blockSize <= sizeof(SkeletonLogBlockHeader)) {
+        Close();
+        return false;
+    }
+    blocks = (size - sizeof(header))/header.blockSize;
+    block = 0;
+    offset = 0;
+    memset(&record, 0, sizeof(record));
+    usersData = NULL;
+    eventsData = NULL;
+    size_t firstBlock = block;
+    size_t firstOffset = offset;
+    end = !FindRecord(firstBlock, firstOffset);
+    return true;
+}
+
+void SkeletonLogReader::Close() {
+    if(data != NULL) {
+        munmap(const_cast<char*>(data), size);
+    }
+    data = NULL;
+    size = 0;
+    blocks = 0;
+    end = true;
+}
+
+bool SkeletonLogReader::IsOpen() {
+    return data != NULL;
+}
+
+bool SkeletonLogReader::IsSmoothed() {
+    return (header.flags & SKELETON_LOG_SMOOTHED) != 0;
+}
+
+int SkeletonLogReader::GetMaxUsers() {
+    return header.maxUsers;
+}
+
+bool SkeletonLogReader::Next() {
+    if(end || !FindRecord(block, offset)) {
+        end = true;
+        return false;
+    }
+    char const* blockData = data + sizeof(header) + block*header.blockSize;
+    SkeletonLogBlockHeader blockHeader;
+    memcpy(&blockHeader, blockData, sizeof(blockHeader));
+    if(!ParseRecord(blockData, blockHeader.usedBytes)) {
+        usersData = NULL;
+        eventsData = NULL;
+        end = true;
+        return false;
+    }
+    //End is known as soon as last record is read, so it is processed like last frame of any other source
+    size_t nextBlock = block;
+    size_t nextOffset = offset;
+    end = !FindRecord(nextBlock, nextOffset);
+    return true;
+}
+
+bool SkeletonLogReader::IsEnd() {
+    return end;
+}
+
+SkeletonLogFrameRecord const& SkeletonLogReader::GetFrameRecord() {
+    return record;
+}
+
+int SkeletonLogReader::GetEventCount() {
+    return eventsData == NULL ? 0 : record.events;
+}
+
+SkeletonLogEventRecord SkeletonLogReader::GetEvent(int index) {
+    SkeletonLogEventRecord event;
+    memcpy(&event, eventsData + index*sizeof(SkeletonLogEventRecord), sizeof(event));
+    return event;
+}
+
+void SkeletonLogReader::FillFrame(SkeletonFrame& frame) {
+    if(usersData == NULL) {
+        return;
+    }
+    frame.timestamp = record.timestamp;
+    frame.silhouettesAvailable = record.silhouettesAvailable;
+    frame.floorAvailable = record.floorAvailable;
+    frame.floor = record.floor;
+    char const* source = usersData;
+    for(int i=0; i < record.users; ++i) {
+        SkeletonLogUserRecord user;
+        memcpy(&user, source, sizeof(user));
+        source += sizeof(user);
+        bool valid = frame.IsValidUser(user.userId);
+        int index = user.userId-1;
+        if(valid) {
+            frame.users.push_back(user.userId);
+            frame.userPresent[index] = true;
+            frame.userCoM[index] = user.com;
+        }
+        if(record.silhouettesAvailable) {
+            if(valid) {
+                memcpy(&frame.silhouettes[index], source, sizeof(UserSilhouette));
+            }
+            source += sizeof(UserSilhouette);
+        }
+        if(!valid || !user.tracked) {
+            source += __builtin_popcount(user.jointMask)*sizeof(SkeletonLogJoint);
+            continue;
+        }
+        frame.userTracked[index] = true;
+        int jointIndex = SkeletonFrame::JointIndex(user.userId, XN_SKEL_HEAD);
+        for(int joint=0; joint < SKELETON_FRAME_JOINTS; ++joint) {
+            SkeletonLogJoint position;
+            if(user.jointMask & (1u << joint)) {
+                memcpy(&position, source, sizeof(position));
+                source += sizeof(position);
+            }
+            else {
+                memset(&position, 0, sizeof(position));
+            }
+            frame.jointX[jointIndex + joint] = position.x;
+            frame.jointY[jointIndex + joint] = position.y;
+            frame.jointZ[jointIndex + joint] = position.z;
+            frame.jointConfidence[jointIndex + joint] = position.confidence;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void SkeletonLogWriter::SealBlock() {
+    char* blockData = blocks[currentBlock].get();
+    SkeletonLogBlockHeader blockHeader;
+    blockHeader.magic = SKELETON_LOG_BLOCK_MAGIC;
+    blockHeader.usedBytes = currentUsed;
+    memcpy(blockData, &blockHeader, sizeof(blockHeader));
+    memset(blockData + currentUsed, 0, SKELETON_LOG_BLOCK_SIZE - currentUsed);
+    //Full queue holds every block, so push cannot fail
+    fullBlocks.Push(currentBlock);
+    currentBlock = -1;
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+}
+
+void SkeletonLogWriter::WriterThreadLoop() {
+    while(running) {
+        Flush();
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait_for(lock, std::chrono::milliseconds(SKELETON_LOG_FLUSH_PERIOD_MS),
+                               [this] { return fullBlocks.Size() > 0 || !running; });
+    }
+}
+
+void SkeletonLogWriter::Flush() {
+    int index;
+    while(fullBlocks.Pop(index)) {
+        fwrite(blocks[index].get(), SKELETON_LOG_BLOCK_SIZE, 1, file);
+        freeBlocks.Push(index);
+    }
+}
+
+bool SkeletonLogReader::FindRecord(size_t& recordBlock, size_t& recordOffset) {
+    while(recordBlock < blocks) {
+        SkeletonLogBlockHeader blockHeader;
+        memcpy(&blockHeader, data + sizeof(header) + recordBlock*header.blockSize, sizeof(blockHeader));
+        if(blockHeader.magic != SKELETON_LOG_BLOCK_MAGIC || blockHeader.usedBytes > header.blockSize) {
+            return false;
+        }
+        if(recordOffset < sizeof(SkeletonLogBlockHeader)) {
+            recordOffset = sizeof(SkeletonLogBlockHeader);
+        }
+        if(recordOffset < blockHeader.usedBytes) {
+            return true;
+        }
+        ++recordBlock;
+        recordOffset = 0;
+    }
+    return false;
+}
+
+bool SkeletonLogReader::ParseRecord(char const* blockData, size_t usedBytes) {
+    //Bounds are checked once here, so FillFrame and GetEvent can walk record without checks
+    size_t position = offset;
+    if(position + sizeof(record) > usedBytes) {
+        return false;
+    }
+    memcpy(&record, blockData + position, sizeof(record));
+    position += sizeof(record);
+    usersData = blockData + position;
+    size_t silhouetteSize = record.silhouettesAvailable ? sizeof(UserSilhouette) : 0;
+    for(int i=0; i < record.users; ++i) {
+        SkeletonLogUserRecord user;
+        if(position + sizeof(user) > usedBytes) {
+            return false;
+        }
+        memcpy(&user, blockData + position, sizeof(user));
+        position += sizeof(user) + silhouetteSize + __builtin_popcount(user.jointMask)*sizeof(SkeletonLogJoint);
+    }
+    eventsData = blockData + position;
+    position += record.events*sizeof(SkeletonLogEventRecord);
+    if(position > usedBytes) {
+        return false;
+    }
+    offset = position;
+    return true;
+}
@@ -0,0 +1,149 @@
+#ifndef ELEKTRON_ESCORT_SKELETON_LOG_H
+#define ELEKTRON_ESCORT_SKELETON_LOG_H
+
+#define SKELETON_LOG_MAGIC 0x4C4B5345u
+#define SKELETON_LOG_BLOCK_MAGIC 0x4B4C4245u
+#define SKELETON_LOG_VERSION 1
+#define SKELETON_LOG_BLOCK_SIZE 65536
+#define SKELETON_LOG_QUEUE_BLOCKS 64
+#define SKELETON_LOG_MAX_EVENTS 256
+#define SKELETON_LOG_FLUSH_PERIOD_MS 100
+#define SKELETON_LOG_SMOOTHED 1u
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <cstdio>
+#include <cstdint>
+#include "SkeletonFrame.h"
+#include "SensorsModule.h"
+#include "../Utilities/SPSC_Queue.h"
+
+
+//Append-only binary log of what modules saw each frame: users, joints, CoM, silhouettes, floor,
+//sensor events processed since previous frame and velocity sent in response. File is header followed by
+//blocks of SKELETON_LOG_BLOCK_SIZE bytes, records never cross blocks, unused tail of block is padding.
+//Record is SkeletonLogFrameRecord, per present user SkeletonLogUserRecord, its UserSilhouette when
+//available and SkeletonLogJoint for every bit of jointMask, then events. Native byte order and layout.
+
+struct SkeletonLogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t blockSize;
+    uint32_t maxUsers;
+    uint32_t joints;
+    uint32_t flags;
+    uint32_t reserved[10];
+};
+
+struct SkeletonLogBlockHeader {
+    uint32_t magic;
+    uint32_t usedBytes;
+};
+
+struct SkeletonLogFrameRecord {
+    double timestamp;
+    uint64_t frameId;
+    float linearVelocity;
+    float angularVelocity;
+    uint16_t users;
+    uint16_t events;
+    uint8_t silhouettesAvailable;
+    uint8_t floorAvailable;
+    uint8_t reserved[2];
+    XnPlane3D floor;
+};
+
+struct SkeletonLogUserRecord {
+    uint32_t userId;
+    uint32_t jointMask;
+    XnPoint3D com;
+    uint8_t tracked;
+    uint8_t reserved[3];
+};
+
+struct SkeletonLogJoint {
+    float x;
+    float y;
+    float z;
+    float confidence;
+};
+
+struct SkeletonLogEventRecord {
+    uint32_t type;
+    uint32_t userId;
+    int32_t calibrationStatus;
+};
+
+//Records are serialized by control thread into free block, full blocks are written to file by background thread.
+//When writer falls behind and no block is free, frames are dropped rather than stalling control loop,
+//unless log is lossless, which is meant for non-live sources that can wait for disk.
+class SkeletonLogWriter {
+public:
+    SkeletonLogWriter() : running(false), droppedFrames(0) {}
+    bool Start(std::string const& fileName, int maxUsers, bool smoothed, bool lossless);
+    void Stop();
+    bool IsRunning();
+    unsigned long GetWrittenFramesCount();
+    unsigned long GetDroppedFramesCount();
+    void Append(SkeletonFrame const& frame, std::vector<SensorEvent> const& events, float linearVelocity, float angularVelocity);
+
+private:
+    FILE* file = NULL;
+    std::vector<std::unique_ptr<char[]>> blocks;
+    SPSC_Queue<int> freeBlocks;
+    SPSC_Queue<int> fullBlocks;
+    bool lossless = false;
+    int currentBlock = -1;
+    size_t currentUsed = 0;
+    unsigned long writtenFrames = 0;
+    std::thread writerThread;
+    std::atomic<bool> running;
+    std::atomic<unsigned long> droppedFrames;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::vector<uint32_t> jointMasks;
+
+    void SealBlock();
+    void WriterThreadLoop();
+    void Flush();
+};
+
+//Memory-mapped sequential reader, record pointers stay valid until Close.
+//Partially written trailing block of interrupted recording is ignored.
+class SkeletonLogReader {
+public:
+    ~SkeletonLogReader();
+    bool Open(std::string const& fileName);
+    void Close();
+    bool IsOpen();
+    bool IsSmoothed();
+    int GetMaxUsers();
+    bool Next();
+    bool IsEnd();
+    SkeletonLogFrameRecord const& GetFrameRecord();
+    int GetEventCount();
+    SkeletonLogEventRecord GetEvent(int index);
+    void FillFrame(SkeletonFrame& frame);
+
+private:
+    char const* data = NULL;
+    size_t size = 0;
+    SkeletonLogHeader header;
+    size_t blocks = 0;
+    size_t block = 0;
+    size_t offset = 0;
+    bool end = false;
+    SkeletonLogFrameRecord record;
+    char const* usersData = NULL;
+    char const* eventsData = NULL;
+
+    bool FindRecord(size_t& recordBlock, size_t& recordOffset);
+    bool ParseRecord(char const* blockData, size_t usedBytes);
+};
+
+#endif //ELEKTRON_ESCORT_SKELETON_LOG_H
@@ -0,0 +1,393 @@
+#include "OpenNI_Source.h"
+#include "../SensorsModule.h"
+#include "../ReplayModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool OpenNI_Source::Initialize(ros::NodeHandle* nodeHandlePrivate) {
+    LogLevels logLevel = SensorsModule::GetInstance().GetLogLevel();
+    XnStatus result = context.Init();
+    if (result != XN_STATUS_OK) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Initialization from Xml file failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    replaying = ReplayModule::GetInstance().IsReplaying();
+    if(replaying) {
+        result = context.OpenFileRecording(ReplayModule::GetInstance().GetReplayFile().c_str(), player);
+        if (result != XN_STATUS_OK) {
+            if(logLevel <= Error) {
+                ROS_ERROR("SensorsModule: Opening recording %s failed: %s", ReplayModule::GetInstance().GetReplayFile().c_str(), xnGetStatusString(result));
+            }
+            return false;
+        }
+        player.SetRepeat(FALSE);
+        if(ReplayModule::GetInstance().IsAsFastAsPossible()) {
+            player.SetPlaybackSpeed(XN_PLAYBACK_SPEED_FASTEST);
+        }
+    }
+    result = context.FindExistingNode(XN_NODE_TYPE_USER, userGenerator);
+    if (result != XN_STATUS_OK) {
+        result = userGenerator.Create(context);
+    }
+    if (result != XN_STATUS_OK) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Create user generator failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    if (!userGenerator.IsCapabilitySupported(XN_CAPABILITY_SKELETON)) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: User generator doesn't support skeleton");
+        }
+        return false;
+    }
+    if (userGenerator.GetSkeletonCap().NeedPoseForCalibration()) {
+        if (!userGenerator.IsCapabilitySupported(XN_CAPABILITY_POSE_DETECTION)) {
+            if(logLevel <= Error) {
+                ROS_ERROR("SensorsModule: Calibration pose required, but not supported");
+            }
+            return false;
+        }
+    }
+    colorEnabled = SensorsModule::GetInstance().IsColorEnabled();
+    silhouettesEnabled = SensorsModule::GetInstance().IsSilhouettesEnabled();
+    if((colorEnabled || silhouettesEnabled) && !InitializeDepth()) {
+        return false;
+    }
+    if(colorEnabled && !InitializeColor()) {
+        return false;
+    }
+    floorEnabled = SensorsModule::GetInstance().IsFloorEnabled();
+    if(floorEnabled && !InitializeFloor()) {
+        return false;
+    }
+    result = context.StartGeneratingAll();
+    if (result != XN_STATUS_OK) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Start generating all failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    userGenerator.GetSkeletonCap().SetSkeletonProfile(XN_SKEL_PROFILE_ALL);
+    userGenerator.RegisterUserCallbacks(User_NewUser, User_LostUser, NULL, userCallbacksHandle);
+    userGenerator.RegisterToUserExit(User_Exit, NULL, userCallbacksHandle);
+    userGenerator.RegisterToUserReEnter(User_ReEnter, NULL, userCallbacksHandle);
+    userGenerator.GetSkeletonCap().RegisterToCalibrationStart(UserCalibration_CalibrationStart, NULL, calibrationCallbacksHandle);
+    userGenerator.GetSkeletonCap().RegisterToCalibrationComplete(UserCalibration_CalibrationComplete, NULL, calibrationCallbacksHandle);
+    userGenerator.GetPoseDetectionCap().RegisterToPoseDetected(UserPose_PoseDetected, NULL, poseCallbacksHandle);
+    userGenerator.GetSkeletonCap().SetSmoothing(SMOOTHING_FACTOR);
+    activeJoints.clear();
+    for(int joint=1; joint <= SKELETON_FRAME_JOINTS; ++joint) {
+        if(userGenerator.GetSkeletonCap().IsJointActive((XnSkeletonJoint)joint)) {
+            activeJoints.push_back((XnSkeletonJoint)joint);
+        }
+    }
+    return true;
+}
+
+void OpenNI_Source::Finish() {
+    context.Release();
+}
+
+bool OpenNI_Source::IsLive() {
+    return !replaying;
+}
+
+bool OpenNI_Source::IsEndOfData() {
+    return replaying && player.IsEOF();
+}
+
+bool OpenNI_Source::IsSmoothed() {
+    return false;
+}
+
+bool OpenNI_Source::WaitForUpdate() {
+    XnStatus result = context.WaitAnyUpdateAll();
+    if(result != XN_STATUS_OK) {
+        if(SensorsModule::GetInstance().GetLogLevel() <= Warn) {
+            ROS_WARN("SensorsModule: Waiting for sensor update failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    return true;
+}
+
+void OpenNI_Source::FillFrame(SkeletonFrame& frame) {
+    frame.timestamp = userGenerator.GetTimestamp()/1000000.0;
+    GetUsers(frameUsers);
+    xn::SkeletonCapability skeleton = userGenerator.GetSkeletonCap();
+    XnSkeletonJointPosition jointPosition;
+    for(int i=0; i < frameUsers.size(); ++i) {
+        if(!frame.IsValidUser(frameUsers[i])) {
+            if(SensorsModule::GetInstance().GetLogLevel() <= Warn) {
+                ROS_WARN("SensorsModule: User: %d- exceeds max users, skipped in frame", frameUsers[i]);
+            }
+            continue;
+        }
+        int index = frameUsers[i]-1;
+        frame.users.push_back(frameUsers[i]);
+        frame.userPresent[index] = true;
+        userGenerator.GetCoM(frameUsers[i], frame.userCoM[index]);
+        if(skeleton.IsTracking(frameUsers[i])) {
+            frame.userTracked[index] = true;
+            for(int j=0; j < activeJoints.size(); ++j) {
+                skeleton.GetSkeletonJointPosition(frameUsers[i], activeJoints[j], jointPosition);
+                frame.SetJoint(frameUsers[i], activeJoints[j], jointPosition);
+            }
+        }
+    }
+    //Label map is shared by both passes
+    if(colorEnabled || silhouettesEnabled) {
+        userGenerator.GetUserPixels(0, sceneMetaData);
+    }
+    if(silhouettesEnabled) {
+        FillSilhouettes(frame);
+    }
+    if(colorEnabled) {
+        FillColor(frame);
+    }
+    if(floorEnabled) {
+        FillFloor(frame);
+    }
+}
+
+void OpenNI_Source::GetUsers(std::vector<XnUserID>& users) {
+    XnUInt16 numberOfUsers = userGenerator.GetNumberOfUsers();
+    users.resize(numberOfUsers);
+    if(numberOfUsers > 0) {
+        userGenerator.GetUsers(&users[0], numberOfUsers);
+        users.resize(numberOfUsers);
+    }
+}
+
+bool OpenNI_Source::IsCalibrating(XnUserID userId) {
+    return userGenerator.GetSkeletonCap().IsCalibrating(userId);
+}
+
+void OpenNI_Source::AbortCalibration(XnUserID userId) {
+    userGenerator.GetSkeletonCap().AbortCalibration(userId);
+}
+
+void OpenNI_Source::RequestCalibration(XnUserID userId) {
+    userGenerator.GetSkeletonCap().RequestCalibration(userId, TRUE);
+}
+
+bool OpenNI_Source::IsCalibrated(XnUserID userId) {
+    return userGenerator.GetSkeletonCap().IsCalibrated(userId);
+}
+
+void OpenNI_Source::ResetCalibration(XnUserID userId) {
+    userGenerator.GetSkeletonCap().Reset(userId);
+}
+
+bool OpenNI_Source::IsTracking(XnUserID userId) {
+    return userGenerator.GetSkeletonCap().IsTracking(userId);
+}
+
+void OpenNI_Source::StartTracking(XnUserID userId) {
+    userGenerator.GetSkeletonCap().StartTracking(userId);
+}
+
+void OpenNI_Source::StopTracking(XnUserID userId) {
+    userGenerator.GetSkeletonCap().StopTracking(userId);
+}
+
+void OpenNI_Source::StartPoseDetection(XnUserID userId) {
+    userGenerator.GetPoseDetectionCap().StartPoseDetection(CALIBRATION_POSE, userId);
+}
+
+bool OpenNI_Source::IsCalibrationData() {
+    return userGenerator.GetSkeletonCap().IsCalibrationData(CALIBRATION_SLOT);
+}
+
+void OpenNI_Source::SaveCalibrationData(XnUserID userId) {
+    userGenerator.GetSkeletonCap().SaveCalibrationData(userId, CALIBRATION_SLOT);
+}
+
+void OpenNI_Source::LoadCalibrationData(XnUserID userId) {
+    userGenerator.GetSkeletonCap().LoadCalibrationData(userId, CALIBRATION_SLOT);
+}
+
+void OpenNI_Source::ClearCalibrationData() {
+    userGenerator.GetSkeletonCap().ClearCalibrationData(CALIBRATION_SLOT);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool OpenNI_Source::InitializeDepth() {
+    XnStatus result = context.FindExistingNode(XN_NODE_TYPE_DEPTH, depthGenerator);
+    if (result != XN_STATUS_OK) {
+        result = depthGenerator.Create(context);
+    }
+    if (result != XN_STATUS_OK) {
+        if(SensorsModule::GetInstance().GetLogLevel() <= Error) {
+            ROS_ERROR("SensorsModule: Create depth generator failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    return true;
+}
+
+bool OpenNI_Source::InitializeColor() {
+    LogLevels logLevel = SensorsModule::GetInstance().GetLogLevel();
+    XnStatus result = context.FindExistingNode(XN_NODE_TYPE_IMAGE, imageGenerator);
+    if (result != XN_STATUS_OK) {
+        result = imageGenerator.Create(context);
+    }
+    if (result != XN_STATUS_OK) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Create image generator failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    imageGenerator.SetPixelFormat(XN_PIXEL_FORMAT_RGB24);
+    //Label map comes from depth, so depth is registered to image viewpoint to make pixels correspond
+    if (!depthGenerator.IsCapabilitySupported(XN_CAPABILITY_ALTERNATIVE_VIEW_POINT)) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Depth generator can't be registered to image");
+        }
+        return false;
+    }
+    result = depthGenerator.GetAlternativeViewPointCap().SetViewPoint(imageGenerator);
+    if (result != XN_STATUS_OK) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Registering depth to image failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    return true;
+}
+
+bool OpenNI_Source::InitializeFloor() {
+    XnStatus result = context.FindExistingNode(XN_NODE_TYPE_SCENE, sceneAnalyzer);
+    if (result != XN_STATUS_OK) {
+        result = sceneAnalyzer.Create(context);
+    }
+    if (result != XN_STATUS_OK) {
+        if(SensorsModule::GetInstance().GetLogLevel() <= Error) {
+            ROS_ERROR("SensorsModule: Create scene analyzer failed: %s", xnGetStatusString(result));
+        }
+        return false;
+    }
+    return true;
+}
+
+void OpenNI_Source::FillColor(SkeletonFrame& frame) {
+    imageGenerator.GetMetaData(imageMetaData);
+    int width = sceneMetaData.XRes();
+    int height = sceneMetaData.YRes();
+    if(imageMetaData.XRes() != width || imageMetaData.YRes() != height) {
+        return;
+    }
+    //Upper and lower body are split at the row of user's center of mass
+    splitRows.assign(frame.maxUsers, height);
+    for(int i=0; i < frame.users.size(); ++i) {
+        int index = frame.users[i]-1;
+        if(frame.userCoM[index].Z > 0.0f) {
+            XnPoint3D projective;
+            depthGenerator.ConvertRealWorldToProjective(1, &frame.userCoM[index], &projective);
+            splitRows[index] = projective.Y;
+        }
+    }
+    colorHistogram.Accumulate(sceneMetaData.Data(), (unsigned char const*)imageMetaData.RGB24Data(), width, height,
+                              COLOR_HISTOGRAM_STEP, splitRows.data(), frame.maxUsers, frame.colorHistograms.data());
+    frame.colorAvailable = true;
+}
+
+void OpenNI_Source::FillSilhouettes(SkeletonFrame& frame) {
+    depthGenerator.GetMetaData(depthMetaData);
+    int width = sceneMetaData.XRes();
+    int height = sceneMetaData.YRes();
+    if(depthMetaData.XRes() != width || depthMetaData.YRes() != height) {
+        return;
+    }
+    labelStatistics.resize(frame.maxUsers);
+    depthReduction.Reduce(sceneMetaData.Data(), depthMetaData.Data(), width, height, frame.maxUsers, labelStatistics.data());
+    //Center, top and bottom of every silhouette at its mean depth are converted in one call
+    silhouettePoints.resize(3*frame.maxUsers);
+    for(int i=0; i < frame.maxUsers; ++i) {
+        LabelDepthStatistics const& label = labelStatistics[i];
+        UserSilhouette& silhouette = frame.silhouettes[i];
+        silhouette.pixels = label.pixels;
+        silhouette.left = label.left;
+        silhouette.top = label.top;
+        silhouette.right = label.right;
+        silhouette.bottom = label.bottom;
+        silhouette.minDepth = label.depthPixels > 0 ? label.minDepth : 0.0f;
+        silhouette.maxDepth = label.maxDepth;
+        silhouette.meanDepth = label.depthPixels > 0 ? (float)label.depthSum/label.depthPixels : 0.0f;
+        float centerX = label.pixels > 0 ? (float)label.xSum/label.pixels : 0.0f;
+        float centerY = label.pixels > 0 ? (float)label.ySum/label.pixels : 0.0f;
+        XnPoint3D* points = &silhouettePoints[3*i];
+        points[0].X = centerX;
+        points[0].Y = centerY;
+        points[1].X = centerX;
+        points[1].Y = label.top;
+        points[2].X = centerX;
+        points[2].Y = label.bottom;
+        for(int j=0; j < 3; ++j) {
+            points[j].Z = silhouette.meanDepth;
+        }
+    }
+    silhouetteWorldPoints.resize(silhouettePoints.size());
+    depthGenerator.ConvertProjectiveToRealWorld(silhouettePoints.size(), silhouettePoints.data(), silhouetteWorldPoints.data());
+    for(int i=0; i < frame.maxUsers; ++i) {
+        UserSilhouette& silhouette = frame.silhouettes[i];
+        silhouette.center = silhouetteWorldPoints[3*i];
+        silhouette.crown = silhouetteWorldPoints[3*i + 1];
+        silhouette.height = silhouette.meanDepth > 0.0f ? silhouetteWorldPoints[3*i + 1].Y - silhouetteWorldPoints[3*i + 2].Y : 0.0f;
+    }
+    frame.silhouettesAvailable = true;
+}
+
+void OpenNI_Source::FillFloor(SkeletonFrame& frame) {
+    //Scene analyzer reports zero normal until it finds the floor
+    if(sceneAnalyzer.GetFloor(frame.floor) != XN_STATUS_OK) {
+        return;
+    }
+    XnVector3D const& normal = frame.floor.vNormal;
+    frame.floorAvailable = normal.X != 0.0f || normal.Y != 0.0f || normal.Z != 0.0f;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Callbacks
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OpenNI_Source::User_NewUser(xn::UserGenerator& generator, XnUserID userId, void* cookie) {
+    SensorsModule::GetInstance().PushEvent(SE_NewUser, userId);
+}
+
+void OpenNI_Source::User_Exit(xn::UserGenerator &generator, XnUserID userId, void *cookie) {
+    SensorsModule::GetInstance().PushEvent(SE_UserExit, userId);
+}
+
+void OpenNI_Source::User_ReEnter(xn::UserGenerator &generator, XnUserID userId, void *cookie)
+{
+    SensorsModule::GetInstance().PushEvent(SE_UserReEnter, userId);
+}
+
+void OpenNI_Source::User_LostUser(xn::UserGenerator& generator, XnUserID userId, void* cookie)
+{
+    SensorsModule::GetInstance().PushEvent(SE_LostUser, userId);
+}
+
+void OpenNI_Source::UserPose_PoseDetected(xn::PoseDetectionCapability& capability, XnChar const* strPose, XnUserID userId, void* pCookie)
+{
+    SensorsModule::GetInstance().PushEvent(SE_PoseDetected, userId);
+}
+
+void OpenNI_Source::UserCalibration_CalibrationStart(xn::SkeletonCapability& skeleton, XnUserID userId, void* cookie)
+{
+    SensorsModule::GetInstance().PushEvent(SE_CalibrationStart, userId);
+}
+
+void OpenNI_Source::UserCalibration_CalibrationComplete(xn::SkeletonCapability& skeleton, XnUserID userId, XnCalibrationStatus calibrationError, void* pCookie)
+{
+    SensorsModule::GetInstance().PushEvent(SE_CalibrationComplete, userId, calibrationError);
+}
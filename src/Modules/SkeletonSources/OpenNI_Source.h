@@ -0,0 +1,81 @@
+#ifndef ELEKTRON_ESCORT_OPENNI_SOURCE_H
+#define ELEKTRON_ESCORT_OPENNI_SOURCE_H
+
+#include <XnOpenNI.h>
+#include <XnCodecIDs.h>
+#include <XnCppWrapper.h>
+#include "Skeleton_Source.h"
+#include "../../Utilities/LabelColorHistogram.h"
+#include "../../Utilities/LabelDepthReduction.h"
+
+
+class OpenNI_Source : public Skeleton_Source {
+public:
+    bool Initialize(ros::NodeHandle* nodeHandlePrivate);
+    void Finish();
+    bool IsLive();
+    bool IsEndOfData();
+    bool IsSmoothed();
+    bool WaitForUpdate();
+    void FillFrame(SkeletonFrame& frame);
+    void GetUsers(std::vector<XnUserID>& users);
+
+    bool IsCalibrating(XnUserID userId);
+    void AbortCalibration(XnUserID userId);
+    void RequestCalibration(XnUserID userId);
+    bool IsCalibrated(XnUserID userId);
+    void ResetCalibration(XnUserID userId);
+    bool IsTracking(XnUserID userId);
+    void StartTracking(XnUserID userId);
+    void StopTracking(XnUserID userId);
+    void StartPoseDetection(XnUserID userId);
+    bool IsCalibrationData();
+    void SaveCalibrationData(XnUserID userId);
+    void LoadCalibrationData(XnUserID userId);
+    void ClearCalibrationData();
+
+private:
+    xn::Context context;
+    xn::Player player;
+    xn::UserGenerator userGenerator;
+    xn::DepthGenerator depthGenerator;
+    xn::ImageGenerator imageGenerator;
+    xn::SceneAnalyzer sceneAnalyzer;
+    xn::SceneMetaData sceneMetaData;
+    xn::ImageMetaData imageMetaData;
+    xn::DepthMetaData depthMetaData;
+    bool replaying = false;
+    bool colorEnabled = false;
+    bool silhouettesEnabled = false;
+    bool floorEnabled = false;
+    LabelColorHistogram colorHistogram;
+    std::vector<int> splitRows;
+    LabelDepthReduction depthReduction;
+    std::vector<LabelDepthStatistics> labelStatistics;
+    std::vector<XnPoint3D> silhouettePoints;
+    std::vector<XnPoint3D> silhouetteWorldPoints;
+    std::vector<XnSkeletonJoint> activeJoints;
+    //Users of frame being filled, capacity is kept between frames
+    std::vector<XnUserID> frameUsers;
+    XnCallbackHandle userCallbacksHandle;
+    XnCallbackHandle calibrationCallbacksHandle;
+    XnCallbackHandle poseCallbacksHandle;
+
+    bool InitializeDepth();
+    bool InitializeColor();
+    bool InitializeFloor();
+    void FillColor(SkeletonFrame& frame);
+    void FillSilhouettes(SkeletonFrame& frame);
+    void FillFloor(SkeletonFrame& frame);
+
+    //Callbacks, only queue events for the main loop
+    static void User_NewUser(xn::UserGenerator& generator, XnUserID userId, void* cookie);
+    static void User_Exit(xn::UserGenerator& generator, XnUserID userId, void* cookie);
+    static void User_ReEnter(xn::UserGenerator& generator, XnUserID userId, void* cookie);
+    static void User_LostUser(xn::UserGenerator& generator, XnUserID userId, void* cookie);
+    static void UserPose_PoseDetected(xn::PoseDetectionCapability& capability, XnChar const* strPose, XnUserID userId, void* pCookie);
+    static void UserCalibration_CalibrationStart(xn::SkeletonCapability& capability, XnUserID userId, void* cookie);
+    static void UserCalibration_CalibrationComplete(xn::SkeletonCapability& skeleton, XnUserID userId, XnCalibrationStatus calibrationError, void* pCookie);
+};
+
+#endif //ELEKTRON_ESCORT_OPENNI_SOURCE_H
@@ -0,0 +1,147 @@
+#include "SkeletonLog_Source.h"
+#include "../SensorsModule.h"
+#include "../ReplayModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SkeletonLog_Source::Initialize(ros::NodeHandle* nodeHandlePrivate) {
+    LogLevels logLevel = SensorsModule::GetInstance().GetLogLevel();
+    std::string fileName = ReplayModule::GetInstance().GetReplayFile();
+    if(fileName.empty()) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Skeleton log source requires replayFile");
+        }
+        return false;
+    }
+    if(!reader.Open(fileName)) {
+        if(logLevel <= Error) {
+            ROS_ERROR("SensorsModule: Failed to open skeleton log: %s", fileName.c_str());
+        }
+        return false;
+    }
+    int maxUsers = DataStorage::GetInstance().GetMaxUsers();
+    if(reader.GetMaxUsers() > maxUsers) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Skeleton log recorded with %d users, users above %d are skipped", reader.GetMaxUsers(), maxUsers);
+        }
+    }
+    if(SensorsModule::GetInstance().IsColorEnabled()) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Skeleton log holds no color, color appearance method will not get template");
+        }
+    }
+    presentUsers.clear();
+    trackedUsers.assign(maxUsers, false);
+    calibrationData = false;
+    lastTimestamp = -1.0;
+    nextFrameTime = std::chrono::steady_clock::now();
+    if(logLevel <= Info) {
+        ROS_INFO("SensorsModule: Skeleton log source: %s%s", fileName.c_str(), reader.IsSmoothed() ? ", joints smoothed on recording" : "");
+    }
+    return true;
+}
+
+void SkeletonLog_Source::Finish() {
+    reader.Close();
+}
+
+bool SkeletonLog_Source::IsLive() {
+    return false;
+}
+
+bool SkeletonLog_Source::IsEndOfData() {
+    return reader.IsEnd();
+}
+
+bool SkeletonLog_Source::IsSmoothed() {
+    return reader.IsSmoothed();
+}
+
+bool SkeletonLog_Source::WaitForUpdate() {
+    if(!reader.Next()) {
+        return false;
+    }
+    double timestamp = reader.GetFrameRecord().timestamp;
+    if(!ReplayModule::GetInstance().IsAsFastAsPossible() && lastTimestamp >= 0.0 && timestamp > lastTimestamp) {
+        nextFrameTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timestamp - lastTimestamp));
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+    else {
+        nextFrameTime = std::chrono::steady_clock::now();
+    }
+    lastTimestamp = timestamp;
+    for(int i=0; i < reader.GetEventCount(); ++i) {
+        SkeletonLogEventRecord event = reader.GetEvent(i);
+        if(event.type < SE_NUMBER_OF_TYPES) {
+            SensorsModule::GetInstance().PushEvent((SensorEventType)event.type, event.userId, (XnCalibrationStatus)event.calibrationStatus);
+        }
+    }
+    return true;
+}
+
+void SkeletonLog_Source::FillFrame(SkeletonFrame& frame) {
+    reader.FillFrame(frame);
+    presentUsers = frame.users;
+    for(int i=0; i < trackedUsers.size(); ++i) {
+        trackedUsers[i] = frame.userTracked[i];
+    }
+}
+
+void SkeletonLog_Source::GetUsers(std::vector<XnUserID>& users) {
+    users = presentUsers;
+}
+
+bool SkeletonLog_Source::IsCalibrating(XnUserID userId) {
+    return false;
+}
+
+void SkeletonLog_Source::AbortCalibration(XnUserID userId) {
+}
+
+void SkeletonLog_Source::RequestCalibration(XnUserID userId) {
+}
+
+bool SkeletonLog_Source::IsCalibrated(XnUserID userId) {
+    return IsTracking(userId);
+}
+
+void SkeletonLog_Source::ResetCalibration(XnUserID userId) {
+}
+
+bool SkeletonLog_Source::IsTracking(XnUserID userId) {
+    return IsValidUser(userId) && trackedUsers[userId-1];
+}
+
+void SkeletonLog_Source::StartTracking(XnUserID userId) {
+}
+
+void SkeletonLog_Source::StopTracking(XnUserID userId) {
+}
+
+void SkeletonLog_Source::StartPoseDetection(XnUserID userId) {
+}
+
+bool SkeletonLog_Source::IsCalibrationData() {
+    return calibrationData;
+}
+
+void SkeletonLog_Source::SaveCalibrationData(XnUserID userId) {
+    calibrationData = true;
+}
+
+void SkeletonLog_Source::LoadCalibrationData(XnUserID userId) {
+}
+
+void SkeletonLog_Source::ClearCalibrationData() {
+    calibrationData = false;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool SkeletonLog_Source::IsValidUser(XnUserID userId) {
+    return userId >= 1 && userId <= trackedUsers.size();
+}
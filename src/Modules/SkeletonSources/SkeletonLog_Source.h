@@ -0,0 +1,48 @@
+#ifndef ELEKTRON_ESCORT_SKELETON_LOG_SOURCE_H
+#define ELEKTRON_ESCORT_SKELETON_LOG_SOURCE_H
+
+#include <thread>
+#include <chrono>
+#include "Skeleton_Source.h"
+#include "../SkeletonLog.h"
+
+
+//Replays skeleton log recorded by ReplayModule from replayFile. Recorded events drive SensorsModule,
+//so calibration and tracking requests change nothing and tracking state is the recorded one.
+class SkeletonLog_Source : public Skeleton_Source {
+public:
+    bool Initialize(ros::NodeHandle* nodeHandlePrivate);
+    void Finish();
+    bool IsLive();
+    bool IsEndOfData();
+    bool IsSmoothed();
+    bool WaitForUpdate();
+    void FillFrame(SkeletonFrame& frame);
+    void GetUsers(std::vector<XnUserID>& users);
+
+    bool IsCalibrating(XnUserID userId);
+    void AbortCalibration(XnUserID userId);
+    void RequestCalibration(XnUserID userId);
+    bool IsCalibrated(XnUserID userId);
+    void ResetCalibration(XnUserID userId);
+    bool IsTracking(XnUserID userId);
+    void StartTracking(XnUserID userId);
+    void StopTracking(XnUserID userId);
+    void StartPoseDetection(XnUserID userId);
+    bool IsCalibrationData();
+    void SaveCalibrationData(XnUserID userId);
+    void LoadCalibrationData(XnUserID userId);
+    void ClearCalibrationData();
+
+private:
+    SkeletonLogReader reader;
+    std::vector<XnUserID> presentUsers;
+    std::vector<bool> trackedUsers;
+    bool calibrationData = false;
+    double lastTimestamp = -1.0;
+    std::chrono::steady_clock::time_point nextFrameTime;
+
+    bool IsValidUser(XnUserID userId);
+};
+
+#endif //ELEKTRON_ESCORT_SKELETON_LOG_SOURCE_H
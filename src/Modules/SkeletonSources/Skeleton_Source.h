@@ -0,0 +1,42 @@
+#ifndef ELEKTRON_ESCORT_SKELETON_SOURCE_H
+#define ELEKTRON_ESCORT_SKELETON_SOURCE_H
+
+#include <vector>
+#include <ros/ros.h>
+#include <XnCppWrapper.h>
+#include "../../Common.h"
+#include "../SkeletonFrame.h"
+
+
+//Provider of skeleton frames and user events for SensorsModule.
+//WaitForUpdate and FillFrame run on the capture thread, events are reported through SensorsModule::PushEvent
+//from inside WaitForUpdate. Remaining calls are made by SensorsModule on capture side between frames.
+//IsSmoothed reports sources whose joints were already smoothed, SensorsModule does not filter them again.
+class Skeleton_Source {
+public:
+    virtual ~Skeleton_Source() {}
+    virtual bool Initialize(ros::NodeHandle* nodeHandlePrivate)=0;
+    virtual void Finish()=0;
+    virtual bool IsLive()=0;
+    virtual bool IsEndOfData()=0;
+    virtual bool IsSmoothed()=0;
+    virtual bool WaitForUpdate()=0;
+    virtual void FillFrame(SkeletonFrame& frame)=0;
+    virtual void GetUsers(std::vector<XnUserID>& users)=0;
+
+    virtual bool IsCalibrating(XnUserID userId)=0;
+    virtual void AbortCalibration(XnUserID userId)=0;
+    virtual void RequestCalibration(XnUserID userId)=0;
+    virtual bool IsCalibrated(XnUserID userId)=0;
+    virtual void ResetCalibration(XnUserID userId)=0;
+    virtual bool IsTracking(XnUserID userId)=0;
+    virtual void StartTracking(XnUserID userId)=0;
+    virtual void StopTracking(XnUserID userId)=0;
+    virtual void StartPoseDetection(XnUserID userId)=0;
+    virtual bool IsCalibrationData()=0;
+    virtual void SaveCalibrationData(XnUserID userId)=0;
+    virtual void LoadCalibrationData(XnUserID userId)=0;
+    virtual void ClearCalibrationData()=0;
+};
+
+#endif //ELEKTRON_ESCORT_SKELETON_SOURCE_H
@@ -0,0 +1,569 @@
+#include "Synthetic_Source.h"
+#include "../SensorsModule.h"
+#include "../ReplayModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool Synthetic_Source::Initialize(ros::NodeHandle* nodeHandlePrivate) {
+    LogLevels logLevel = SensorsModule::GetInstance().GetLogLevel();
+    int seed;
+    double meanHeight;
+    double heightDeviation;
+    double walkingSpeed;
+    double stepFrequency;
+    std::string scenario;
+    if(!nodeHandlePrivate->getParam("syntheticUsers", numberOfUsers)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Value of syntheticUsers not found, using default: %d", DEFAULT_SYNTHETIC_USERS);
+        }
+        numberOfUsers = DEFAULT_SYNTHETIC_USERS;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticSeed", seed)) {
+        seed = DEFAULT_SYNTHETIC_SEED;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticFrameRate", frameRate)) {
+        frameRate = DEFAULT_SYNTHETIC_FRAME_RATE;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticDuration", duration)) {
+        duration = DEFAULT_SYNTHETIC_DURATION;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticMeanHeight", meanHeight)) {
+        meanHeight = DEFAULT_SYNTHETIC_MEAN_HEIGHT;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticHeightDeviation", heightDeviation)) {
+        heightDeviation = DEFAULT_SYNTHETIC_HEIGHT_DEVIATION;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticWalkingSpeed", walkingSpeed)) {
+        walkingSpeed = DEFAULT_SYNTHETIC_WALKING_SPEED;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticStepFrequency", stepFrequency)) {
+        stepFrequency = DEFAULT_SYNTHETIC_STEP_FREQUENCY;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticOcclusionRate", occlusionRate)) {
+        occlusionRate = DEFAULT_SYNTHETIC_OCCLUSION_RATE;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticIdSwapRate", idSwapRate)) {
+        idSwapRate = DEFAULT_SYNTHETIC_ID_SWAP_RATE;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticPoseTime", poseTime)) {
+        poseTime = DEFAULT_SYNTHETIC_POSE_TIME;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticPosePeriod", posePeriod)) {
+        posePeriod = DEFAULT_SYNTHETIC_POSE_PERIOD;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticScenario", scenario)) {
+        scenario = DEFAULT_SYNTHETIC_SCENARIO;
+    }
+    if(!nodeHandlePrivate->getParam("syntheticCrossingSwapProbability", crossingSwapProbability)) {
+        crossingSwapProbability = DEFAULT_SYNTHETIC_CROSSING_SWAP_PROBABILITY;
+    }
+    if(scenario == "crossing") {
+        crossingScenario = true;
+    }
+    else {
+        if(scenario != "crowd") {
+            if(logLevel <= Warn) {
+                ROS_WARN("SensorsModule: Requested invalid synthetic scenario: %s, using default: %s", scenario.c_str(), DEFAULT_SYNTHETIC_SCENARIO);
+            }
+            scenario = DEFAULT_SYNTHETIC_SCENARIO;
+        }
+        crossingScenario = false;
+    }
+    if(frameRate <= 0.0) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Requested invalid synthetic frame rate: %f", frameRate);
+        }
+        frameRate = DEFAULT_SYNTHETIC_FRAME_RATE;
+    }
+    maxUsers = DataStorage::GetInstance().GetMaxUsers();
+    if(numberOfUsers < 1 || numberOfUsers > maxUsers) {
+        if(logLevel <= Warn) {
+            ROS_WARN("SensorsModule: Requested invalid number of synthetic users: %d, max users: %d", numberOfUsers, maxUsers);
+        }
+        numberOfUsers = std::max(1, std::min(numberOfUsers, maxUsers));
+    }
+    generator.seed(seed);
+    userStates.assign(maxUsers, UserState());
+    for(int i=0; i < maxUsers; ++i) {
+        userStates[i].inUse = false;
+    }
+    std::normal_distribution<double> heightDistribution(meanHeight, heightDeviation);
+    persons.resize(numberOfUsers);
+    for(int i=0; i < numberOfUsers; ++i) {
+        Person& person = persons[i];
+        person.userId = AcquireUserId();
+        person.height = heightDistribution(generator);
+        person.speed = walkingSpeed*Uniform(0.6, 1.4);
+        person.stepFrequency = stepFrequency*Uniform(0.8, 1.2);
+        person.gaitPhase = Uniform(0.0, 2*M_PI);
+        person.x = Uniform(SYNTHETIC_MIN_X, SYNTHETIC_MAX_X);
+        person.z = Uniform(SYNTHETIC_MIN_Z, SYNTHETIC_MAX_Z);
+        double heading = Uniform(0.0, 2*M_PI);
+        person.headingX = cos(heading);
+        person.headingZ = sin(heading);
+        person.visible = true;
+        person.lost = false;
+        person.occlusionTime = 0.0;
+        person.occlusionDuration = 0.0;
+    }
+    if(crossingScenario) {
+        PlaceInLanes();
+    }
+    silhouettesEnabled = SensorsModule::GetInstance().IsSilhouettesEnabled();
+    floorEnabled = SensorsModule::GetInstance().IsFloorEnabled();
+    //Clothing has own generator, so enabling color does not change generated crowd
+    colorEnabled = SensorsModule::GetInstance().IsColorEnabled();
+    if(colorEnabled) {
+        std::mt19937 colorGenerator(seed + 1);
+        std::uniform_int_distribution<int> binDistribution(0, COLOR_HISTOGRAM_BINS - 1);
+        for(int i=0; i < numberOfUsers; ++i) {
+            for(int region=0; region < COLOR_HISTOGRAM_REGIONS; ++region) {
+                persons[i].colors[region][0] = binDistribution(colorGenerator);
+                persons[i].colors[region][1] = binDistribution(colorGenerator);
+            }
+        }
+    }
+    time = 0.0;
+    nextPoseTime = poseTime;
+    started = false;
+    calibrationData = false;
+    crossings = 0;
+    idSwaps = 0;
+    nextFrameTime = std::chrono::steady_clock::now();
+    if(logLevel <= Info) {
+        ROS_INFO("SensorsModule: Synthetic source with %d users, seed %d, %s scenario", numberOfUsers, seed, scenario.c_str());
+    }
+    return true;
+}
+
+void Synthetic_Source::Finish() {
+}
+
+bool Synthetic_Source::IsLive() {
+    return false;
+}
+
+bool Synthetic_Source::IsEndOfData() {
+    return duration > 0.0 && time >= duration;
+}
+
+bool Synthetic_Source::IsSmoothed() {
+    return false;
+}
+
+bool Synthetic_Source::WaitForUpdate() {
+    double timeElapsed = 1.0/frameRate;
+    if(!ReplayModule::GetInstance().IsAsFastAsPossible()) {
+        nextFrameTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(timeElapsed));
+        std::this_thread::sleep_until(nextFrameTime);
+    }
+    time += timeElapsed;
+    if(!started) {
+        for(int i=0; i < persons.size(); ++i) {
+            SensorsModule::GetInstance().PushEvent(SE_NewUser, persons[i].userId);
+        }
+        started = true;
+    }
+    previousX.resize(persons.size());
+    for(int i=0; i < persons.size(); ++i) {
+        previousX[i] = persons[i].x;
+        MovePerson(persons[i], timeElapsed);
+        UpdateOcclusion(persons[i], timeElapsed);
+    }
+    if(crossingScenario) {
+        SwapUserIdsOnCrossings();
+    }
+    else if(Uniform(0.0, 1.0) < idSwapRate*timeElapsed) {
+        SwapUserIds();
+    }
+    UpdateCalibration(timeElapsed);
+    UpdatePose();
+    return true;
+}
+
+void Synthetic_Source::FillFrame(SkeletonFrame& frame) {
+    frame.timestamp = time;
+    frame.colorAvailable = colorEnabled;
+    frame.silhouettesAvailable = silhouettesEnabled;
+    frame.floorAvailable = floorEnabled;
+    frame.floor.vNormal.X = 0.0f;
+    frame.floor.vNormal.Y = 1.0f;
+    frame.floor.vNormal.Z = 0.0f;
+    frame.floor.ptPoint.X = 0.0f;
+    frame.floor.ptPoint.Y = -SYNTHETIC_SENSOR_HEIGHT;
+    frame.floor.ptPoint.Z = 0.0f;
+    for(int i=0; i < persons.size(); ++i) {
+        Person const& person = persons[i];
+        if(!person.visible || !frame.IsValidUser(person.userId)) {
+            continue;
+        }
+        int index = person.userId-1;
+        frame.users.push_back(person.userId);
+        frame.userPresent[index] = true;
+        frame.userCoM[index].X = person.x;
+        frame.userCoM[index].Y = -SYNTHETIC_SENSOR_HEIGHT + 0.55*person.height + 0.01*person.height*fabs(sin(person.gaitPhase));
+        frame.userCoM[index].Z = person.z;
+        if(colorEnabled) {
+            FillColor(frame, person);
+        }
+        if(silhouettesEnabled) {
+            FillSilhouette(frame, person);
+        }
+        if(userStates[index].tracking) {
+            frame.userTracked[index] = true;
+            FillJoints(frame, person);
+        }
+    }
+}
+
+void Synthetic_Source::GetUsers(std::vector<XnUserID>& users) {
+    users.clear();
+    for(int i=0; i < maxUsers; ++i) {
+        if(userStates[i].inUse) {
+            users.push_back(i+1);
+        }
+    }
+}
+
+bool Synthetic_Source::IsCalibrating(XnUserID userId) {
+    return IsValidUser(userId) && userStates[userId-1].calibrating;
+}
+
+void Synthetic_Source::AbortCalibration(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].calibrationRequested = false;
+        userStates[userId-1].calibrating = false;
+    }
+}
+
+void Synthetic_Source::RequestCalibration(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].calibrationRequested = true;
+    }
+}
+
+bool Synthetic_Source::IsCalibrated(XnUserID userId) {
+    return IsValidUser(userId) && userStates[userId-1].calibrated;
+}
+
+void Synthetic_Source::ResetCalibration(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].calibrated = false;
+        userStates[userId-1].tracking = false;
+    }
+}
+
+bool Synthetic_Source::IsTracking(XnUserID userId) {
+    return IsValidUser(userId) && userStates[userId-1].tracking;
+}
+
+void Synthetic_Source::StartTracking(XnUserID userId) {
+    if(IsValidUser(userId) && userStates[userId-1].calibrated) {
+        userStates[userId-1].tracking = true;
+    }
+}
+
+void Synthetic_Source::StopTracking(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].tracking = false;
+    }
+}
+
+void Synthetic_Source::StartPoseDetection(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].poseDetection = true;
+    }
+}
+
+bool Synthetic_Source::IsCalibrationData() {
+    return calibrationData;
+}
+
+void Synthetic_Source::SaveCalibrationData(XnUserID userId) {
+    if(IsCalibrated(userId)) {
+        calibrationData = true;
+    }
+}
+
+void Synthetic_Source::LoadCalibrationData(XnUserID userId) {
+    if(IsValidUser(userId) && calibrationData) {
+        userStates[userId-1].calibrated = true;
+    }
+}
+
+void Synthetic_Source::ClearCalibrationData() {
+    calibrationData = false;
+}
+
+int Synthetic_Source::GetPersonOfUser(XnUserID userId) {
+    for(int i=0; i < persons.size(); ++i) {
+        if(persons[i].userId == userId && persons[i].visible) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+unsigned long Synthetic_Source::GetCrossingsCount() {
+    return crossings;
+}
+
+unsigned long Synthetic_Source::GetIdSwapsCount() {
+    return idSwaps;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+double Synthetic_Source::Uniform(double min, double max) {
+    std::uniform_real_distribution<double> distribution(min, max);
+    return distribution(generator);
+}
+
+bool Synthetic_Source::IsValidUser(XnUserID userId) {
+    return userId >= 1 && userId <= maxUsers;
+}
+
+XnUserID Synthetic_Source::AcquireUserId() {
+    for(int i=0; i < maxUsers; ++i) {
+        if(!userStates[i].inUse) {
+            userStates[i].inUse = true;
+            userStates[i].poseDetection = false;
+            userStates[i].calibrationRequested = false;
+            userStates[i].calibrating = false;
+            userStates[i].calibrationTimeLeft = 0.0;
+            userStates[i].calibrated = false;
+            userStates[i].tracking = false;
+            return i+1;
+        }
+    }
+    return NO_USER;
+}
+
+void Synthetic_Source::ReleaseUserId(XnUserID userId) {
+    if(IsValidUser(userId)) {
+        userStates[userId-1].inUse = false;
+    }
+}
+
+void Synthetic_Source::MovePerson(Person& person, double timeElapsed) {
+    person.x += person.headingX*person.speed*timeElapsed;
+    person.z += person.headingZ*person.speed*timeElapsed;
+    if(person.x < SYNTHETIC_MIN_X || person.x > SYNTHETIC_MAX_X) {
+        person.headingX = -person.headingX;
+        person.x = std::max(SYNTHETIC_MIN_X, std::min(person.x, SYNTHETIC_MAX_X));
+    }
+    if(person.z < SYNTHETIC_MIN_Z || person.z > SYNTHETIC_MAX_Z) {
+        person.headingZ = -person.headingZ;
+        person.z = std::max(SYNTHETIC_MIN_Z, std::min(person.z, SYNTHETIC_MAX_Z));
+    }
+    person.gaitPhase = fmod(person.gaitPhase + 2*M_PI*person.stepFrequency*timeElapsed, 2*M_PI);
+}
+
+void Synthetic_Source::UpdateOcclusion(Person& person, double timeElapsed) {
+    if(person.visible) {
+        if(Uniform(0.0, 1.0) < occlusionRate*timeElapsed) {
+            person.visible = false;
+            person.occlusionTime = 0.0;
+            person.occlusionDuration = Uniform(0.2, SYNTHETIC_MAX_OCCLUSION_TIME);
+            SensorsModule::GetInstance().PushEvent(SE_UserExit, person.userId);
+        }
+        return;
+    }
+    person.occlusionTime += timeElapsed;
+    if(!person.lost && person.occlusionTime >= SYNTHETIC_LOST_TIME) {
+        SensorsModule::GetInstance().PushEvent(SE_LostUser, person.userId);
+        ReleaseUserId(person.userId);
+        person.lost = true;
+    }
+    if(person.occlusionTime >= person.occlusionDuration) {
+        if(person.lost) {
+            XnUserID userId = AcquireUserId();
+            if(userId == NO_USER) {
+                return;
+            }
+            person.userId = userId;
+            person.lost = false;
+            person.visible = true;
+            SensorsModule::GetInstance().PushEvent(SE_NewUser, person.userId);
+        }
+        else {
+            person.visible = true;
+            SensorsModule::GetInstance().PushEvent(SE_UserReEnter, person.userId);
+        }
+    }
+}
+
+void Synthetic_Source::SwapUserIds() {
+    //NITE keeps tracking state with user id, so only persons behind ids are exchanged
+    std::vector<int> visiblePersons;
+    for(int i=0; i < persons.size(); ++i) {
+        if(persons[i].visible) {
+            visiblePersons.push_back(i);
+        }
+    }
+    if(visiblePersons.size() < 2) {
+        return;
+    }
+    std::uniform_int_distribution<int> distribution(0, visiblePersons.size()-1);
+    int first = visiblePersons[distribution(generator)];
+    int second = visiblePersons[distribution(generator)];
+    if(first != second) {
+        std::swap(persons[first].userId, persons[second].userId);
+        ++idSwaps;
+        if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
+            ROS_DEBUG("SensorsModule: Synthetic users %d and %d swapped", persons[first].userId, persons[second].userId);
+        }
+    }
+}
+
+void Synthetic_Source::PlaceInLanes() {
+    //Pair shares lane parallel to sensor, one starts on the left walking right, the other on the right walking left
+    int lanes = (persons.size() + 1)/2;
+    double laneWidth = (SYNTHETIC_MAX_Z - SYNTHETIC_MIN_Z)/lanes;
+    for(int i=0; i < persons.size(); ++i) {
+        Person& person = persons[i];
+        bool fromLeft = i%2 == 0;
+        person.z = SYNTHETIC_MIN_Z + (i/2 + 0.5)*laneWidth + Uniform(-0.1, 0.1)*laneWidth;
+        person.x = fromLeft ? Uniform(SYNTHETIC_MIN_X, SYNTHETIC_MIN_X/2) : Uniform(SYNTHETIC_MAX_X/2, SYNTHETIC_MAX_X);
+        person.headingX = fromLeft ? 1.0 : -1.0;
+        person.headingZ = 0.0;
+    }
+}
+
+void Synthetic_Source::SwapUserIdsOnCrossings() {
+    //Persons cross when their order along x changes between frames while they are close in depth
+    for(int i=0; i < persons.size(); ++i) {
+        for(int j=i+1; j < persons.size(); ++j) {
+            Person& first = persons[i];
+            Person& second = persons[j];
+            if(!first.visible || !second.visible || fabs(first.z - second.z) > SYNTHETIC_CROSSING_DISTANCE) {
+                continue;
+            }
+            if((previousX[i] < previousX[j]) == (first.x < second.x)) {
+                continue;
+            }
+            ++crossings;
+            if(Uniform(0.0, 1.0) < crossingSwapProbability) {
+                std::swap(first.userId, second.userId);
+                ++idSwaps;
+                if(SensorsModule::GetInstance().GetLogLevel() <= Debug) {
+                    ROS_DEBUG("SensorsModule: Synthetic users %d and %d swapped on crossing", first.userId, second.userId);
+                }
+            }
+        }
+    }
+}
+
+void Synthetic_Source::UpdateCalibration(double timeElapsed) {
+    for(int i=0; i < maxUsers; ++i) {
+        UserState& userState = userStates[i];
+        if(!userState.inUse) {
+            continue;
+        }
+        if(userState.calibrationRequested) {
+            userState.calibrationRequested = false;
+            userState.calibrating = true;
+            userState.calibrationTimeLeft = SYNTHETIC_CALIBRATION_TIME;
+            SensorsModule::GetInstance().PushEvent(SE_CalibrationStart, i+1);
+        }
+        else if(userState.calibrating) {
+            userState.calibrationTimeLeft -= timeElapsed;
+            if(userState.calibrationTimeLeft <= 0.0) {
+                userState.calibrating = false;
+                userState.calibrated = true;
+                SensorsModule::GetInstance().PushEvent(SE_CalibrationComplete, i+1, XN_CALIBRATION_STATUS_OK);
+            }
+        }
+    }
+}
+
+void Synthetic_Source::UpdatePose() {
+    if(time < nextPoseTime) {
+        return;
+    }
+    Person const& escorted = persons[0];
+    if(!escorted.visible || !userStates[escorted.userId-1].poseDetection) {
+        return;
+    }
+    SensorsModule::GetInstance().PushEvent(SE_PoseDetected, escorted.userId);
+    nextPoseTime = posePeriod > 0.0 ? nextPoseTime + posePeriod : std::numeric_limits<double>::infinity();
+}
+
+void Synthetic_Source::FillJoints(SkeletonFrame& frame, Person const& person) {
+    double floor = -SYNTHETIC_SENSOR_HEIGHT;
+    double height = person.height;
+    double swing = 0.1*height*sin(person.gaitPhase);
+    double bob = 0.01*height*fabs(sin(person.gaitPhase));
+    struct JointModel {
+        XnSkeletonJoint joint;
+        double x;
+        double y;
+        double swing;
+    };
+    //Proportions of body height, swing sign alternates between sides
+    static const JointModel model[] = {
+        {XN_SKEL_HEAD, 0.0, 0.93, 0.0},
+        {XN_SKEL_NECK, 0.0, 0.82, 0.0},
+        {XN_SKEL_TORSO, 0.0, 0.65, 0.0},
+        {XN_SKEL_LEFT_SHOULDER, -0.13, 0.81, 0.0},
+        {XN_SKEL_LEFT_ELBOW, -0.15, 0.63, -0.5},
+        {XN_SKEL_LEFT_HAND, -0.16, 0.48, -1.0},
+        {XN_SKEL_RIGHT_SHOULDER, 0.13, 0.81, 0.0},
+        {XN_SKEL_RIGHT_ELBOW, 0.15, 0.63, 0.5},
+        {XN_SKEL_RIGHT_HAND, 0.16, 0.48, 1.0},
+        {XN_SKEL_LEFT_HIP, -0.055, 0.52, 0.0},
+        {XN_SKEL_LEFT_KNEE, -0.055, 0.285, 0.5},
+        {XN_SKEL_LEFT_FOOT, -0.055, 0.04, 1.0},
+        {XN_SKEL_RIGHT_HIP, 0.055, 0.52, 0.0},
+        {XN_SKEL_RIGHT_KNEE, 0.055, 0.285, -0.5},
+        {XN_SKEL_RIGHT_FOOT, 0.055, 0.04, -1.0}
+    };
+    XnSkeletonJointPosition jointPosition;
+    jointPosition.fConfidence = 1.0f;
+    for(int i=0; i < sizeof(model)/sizeof(model[0]); ++i) {
+        jointPosition.position.X = person.x + model[i].x*height;
+        jointPosition.position.Y = floor + model[i].y*height + bob;
+        jointPosition.position.Z = person.z + model[i].swing*swing;
+        frame.SetJoint(person.userId, model[i].joint, jointPosition);
+    }
+}
+
+void Synthetic_Source::FillColor(SkeletonFrame& frame, Person const& person) {
+    //Primary color of clothing with secondary pattern, their share changes with gait like lit folds would
+    double share = SYNTHETIC_PRIMARY_COLOR_SHARE - 0.1*fabs(sin(person.gaitPhase));
+    for(int region=0; region < COLOR_HISTOGRAM_REGIONS; ++region) {
+        float* histogram = frame.GetColorHistogram(person.userId, (ColorRegions)region);
+        std::fill(histogram, histogram + COLOR_HISTOGRAM_BINS, 0.0f);
+        histogram[person.colors[region][0]] += share;
+        histogram[person.colors[region][1]] += 1.0 - share;
+    }
+}
+
+void Synthetic_Source::FillSilhouette(SkeletonFrame& frame, Person const& person) {
+    //Upright box of the person seen through pinhole camera, mask covers about half of it
+    double scale = SYNTHETIC_FOCAL_LENGTH/person.z;
+    double floor = -SYNTHETIC_SENSOR_HEIGHT;
+    double halfWidth = 0.5*SYNTHETIC_BODY_WIDTH*person.height;
+    UserSilhouette& silhouette = frame.silhouettes[person.userId-1];
+    silhouette.left = std::max(0, (int)(SYNTHETIC_DEPTH_WIDTH/2 + (person.x - halfWidth)*scale));
+    silhouette.right = std::min(SYNTHETIC_DEPTH_WIDTH - 1, (int)(SYNTHETIC_DEPTH_WIDTH/2 + (person.x + halfWidth)*scale));
+    silhouette.top = std::max(0, (int)(SYNTHETIC_DEPTH_HEIGHT/2 - (floor + person.height)*scale));
+    silhouette.bottom = std::min(SYNTHETIC_DEPTH_HEIGHT - 1, (int)(SYNTHETIC_DEPTH_HEIGHT/2 - floor*scale));
+    if(silhouette.right < silhouette.left || silhouette.bottom < silhouette.top) {
+        silhouette.pixels = 0;
+        return;
+    }
+    silhouette.pixels = (silhouette.right - silhouette.left + 1)*(silhouette.bottom - silhouette.top + 1)/2;
+    silhouette.meanDepth = person.z;
+    silhouette.minDepth = person.z - SYNTHETIC_BODY_DEPTH/2;
+    silhouette.maxDepth = person.z + SYNTHETIC_BODY_DEPTH/2;
+    silhouette.height = (silhouette.bottom - silhouette.top)/scale;
+    silhouette.center = frame.userCoM[person.userId-1];
+    silhouette.crown.X = person.x;
+    silhouette.crown.Y = floor + person.height;
+    silhouette.crown.Z = person.z;
+}
@@ -0,0 +1,144 @@
+#ifndef ELEKTRON_ESCORT_SYNTHETIC_SOURCE_H
+#define ELEKTRON_ESCORT_SYNTHETIC_SOURCE_H
+
+#define DEFAULT_SYNTHETIC_USERS 10
+#define DEFAULT_SYNTHETIC_SEED 0
+#define DEFAULT_SYNTHETIC_FRAME_RATE 30.0
+#define DEFAULT_SYNTHETIC_DURATION 0.0
+#define DEFAULT_SYNTHETIC_MEAN_HEIGHT 1750.0
+#define DEFAULT_SYNTHETIC_HEIGHT_DEVIATION 80.0
+#define DEFAULT_SYNTHETIC_WALKING_SPEED 1000.0
+#define DEFAULT_SYNTHETIC_STEP_FREQUENCY 1.8
+#define DEFAULT_SYNTHETIC_OCCLUSION_RATE 0.05
+#define DEFAULT_SYNTHETIC_ID_SWAP_RATE 0.01
+#define DEFAULT_SYNTHETIC_POSE_TIME 1.0
+#define DEFAULT_SYNTHETIC_POSE_PERIOD 0.0
+#define DEFAULT_SYNTHETIC_SCENARIO "crowd"
+#define DEFAULT_SYNTHETIC_CROSSING_SWAP_PROBABILITY 0.5
+#define SYNTHETIC_SENSOR_HEIGHT 1000.0
+#define SYNTHETIC_CALIBRATION_TIME 0.5
+#define SYNTHETIC_LOST_TIME 2.0
+#define SYNTHETIC_MAX_OCCLUSION_TIME 3.0
+#define SYNTHETIC_MIN_X -2500.0
+#define SYNTHETIC_MAX_X 2500.0
+#define SYNTHETIC_MIN_Z 800.0
+#define SYNTHETIC_MAX_Z 6000.0
+#define SYNTHETIC_PRIMARY_COLOR_SHARE 0.8
+#define SYNTHETIC_DEPTH_WIDTH 640
+#define SYNTHETIC_DEPTH_HEIGHT 480
+#define SYNTHETIC_FOCAL_LENGTH 525.0
+#define SYNTHETIC_BODY_WIDTH 0.26
+#define SYNTHETIC_BODY_DEPTH 300.0
+#define SYNTHETIC_CROSSING_DISTANCE 400.0
+
+#include <random>
+#include <thread>
+#include <limits>
+#include <cmath>
+#include <chrono>
+#include "Skeleton_Source.h"
+
+
+//Generates walking crowd with occlusions and NITE-like user id swaps.
+//First generated person is the one showing calibration pose.
+//In crossing scenario persons walk in pairs towards each other along lanes, and ids are swapped
+//only when two persons pass each other closely, which is when NITE confuses them.
+class Synthetic_Source : public Skeleton_Source {
+public:
+    bool Initialize(ros::NodeHandle* nodeHandlePrivate);
+    void Finish();
+    bool IsLive();
+    bool IsEndOfData();
+    bool IsSmoothed();
+    bool WaitForUpdate();
+    void FillFrame(SkeletonFrame& frame);
+    void GetUsers(std::vector<XnUserID>& users);
+
+    bool IsCalibrating(XnUserID userId);
+    void AbortCalibration(XnUserID userId);
+    void RequestCalibration(XnUserID userId);
+    bool IsCalibrated(XnUserID userId);
+    void ResetCalibration(XnUserID userId);
+    bool IsTracking(XnUserID userId);
+    void StartTracking(XnUserID userId);
+    void StopTracking(XnUserID userId);
+    void StartPoseDetection(XnUserID userId);
+    bool IsCalibrationData();
+    void SaveCalibrationData(XnUserID userId);
+    void LoadCalibrationData(XnUserID userId);
+    void ClearCalibrationData();
+
+    //Ground truth for benchmarks, index of person currently behind user id or -1
+    int GetPersonOfUser(XnUserID userId);
+    unsigned long GetCrossingsCount();
+    unsigned long GetIdSwapsCount();
+
+private:
+    struct Person {
+        XnUserID userId;
+        double height;
+        double speed;
+        double stepFrequency;
+        double gaitPhase;
+        double x;
+        double z;
+        double headingX;
+        double headingZ;
+        bool visible;
+        bool lost;
+        double occlusionTime;
+        double occlusionDuration;
+        int colors[COLOR_HISTOGRAM_REGIONS][2];
+    };
+    struct UserState {
+        bool inUse;
+        bool poseDetection;
+        bool calibrationRequested;
+        bool calibrating;
+        double calibrationTimeLeft;
+        bool calibrated;
+        bool tracking;
+    };
+
+    int maxUsers;
+    int numberOfUsers;
+    double frameRate;
+    double duration;
+    double occlusionRate;
+    double idSwapRate;
+    double poseTime;
+    double posePeriod;
+    bool crossingScenario;
+    double crossingSwapProbability;
+    unsigned long crossings = 0;
+    unsigned long idSwaps = 0;
+    double time = 0.0;
+    double nextPoseTime;
+    bool started = false;
+    bool calibrationData = false;
+    bool colorEnabled = false;
+    bool silhouettesEnabled = false;
+    bool floorEnabled = false;
+    std::mt19937 generator;
+    std::vector<Person> persons;
+    std::vector<double> previousX;
+    std::vector<UserState> userStates;
+    std::chrono::steady_clock::time_point nextFrameTime;
+
+    double Uniform(double min, double max);
+    bool IsValidUser(XnUserID userId);
+    XnUserID AcquireUserId();
+    void ReleaseUserId(XnUserID userId);
+    void MovePerson(Person& person, double timeElapsed);
+    void UpdateOcclusion(Person& person, double timeElapsed);
+    void SwapUserIds();
+    void PlaceInLanes();
+    void SwapUserIdsOnCrossings();
+    void UpdateCalibration(double timeElapsed);
+    void UpdatePose();
+    void FillJoints(SkeletonFrame& frame, Person const& person);
+    void FillColor(SkeletonFrame& frame, Person const& person);
+    void FillSilhouette(SkeletonFrame& frame, Person const& person);
+};
+
+#endif //ELEKTRON_ESCORT_SYNTHETIC_SOURCE_H
@@ -1,5 +1,6 @@
 #include "TaskModule.h"
 #include "MobilityModule.h"
+#include "DiagnosticsModule.h"
 
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -49,9 +50,16 @@ bool TaskModule::Initialize(ros::NodeHandle *nodeHandlePrivate) {
         }
         maxUserDistance = DEFAULT_MAX_USER_DISTANCE;
     }
+    if(!nodeHandlePrivate->getParam("occlusionCoastTime", occlusionCoastTime)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TaskModule: Value of occlusionCoastTime not found, using default: %f", DEFAULT_OCCLUSION_COAST_TIME);
+        }
+        occlusionCoastTime = DEFAULT_OCCLUSION_COAST_TIME;
+    }
     timeElapsed = 0.0;
     SensorsModule::GetInstance().BeginCalibration();
     state = Awaiting;
+    DiagnosticsModule::GetInstance().TraceInstant("task/awaiting", "state");
     if(logLevel <= Info) {
         ROS_INFO("TaskModule: Initialized");
     }
@@ -107,7 +115,9 @@ void TaskModule::AwaitingStateEnter() {
             SensorsModule::GetInstance().BeginCalibration();
             break;
     }
+    DataStorage::GetInstance().ResetFollowedUserTrack();
     state = Awaiting;
+    DiagnosticsModule::GetInstance().TraceInstant("task/awaiting", "state");
     if(logLevel <= Info) {
         ROS_INFO("TaskModule: Awaiting for user registration");
     }
@@ -115,6 +125,7 @@ void TaskModule::AwaitingStateEnter() {
 
 void TaskModule::SavingStateEnter() {
     state = Saving;
+    DiagnosticsModule::GetInstance().TraceInstant("task/saving", "state");
     IdentificationModule::GetInstance().SaveTemplateOfCurrentUser();
     if(logLevel <= Info) {
         ROS_INFO("TaskModule: Saving template");
@@ -135,6 +146,7 @@ void TaskModule::FollowingStateEnter() {
             break;
     }
     state = Following;
+    DiagnosticsModule::GetInstance().TraceInstant("task/following", "state");
     if(logLevel <= Info) {
         ROS_INFO("TaskModule: Following user: %d", DataStorage::GetInstance().GetCurrentUserXnId());
     }
@@ -142,6 +154,7 @@ void TaskModule::FollowingStateEnter() {
 
 void TaskModule::WaitingStateEnter() {
     state = Waiting;
+    DiagnosticsModule::GetInstance().TraceInstant("task/waiting", "state");
     timeElapsed = 0.0;
     MobilityModule::GetInstance().SetState(Stop);
     if(logLevel <= Info) {
@@ -151,6 +164,7 @@ void TaskModule::WaitingStateEnter() {
 
 void TaskModule::SearchingStateEnter() {
     state = Searching;
+    DiagnosticsModule::GetInstance().TraceInstant("task/searching", "state");
     timeElapsed = 0.0;
     MobilityModule::GetInstance().SetState(SearchForUser);
     if(logLevel <= Info) {
@@ -183,11 +197,15 @@ void TaskModule::SavingTemplateUpdate() {
 }
 
 void TaskModule::FollowingStateUpdate() {
-    if(DataStorage::GetInstance().GetCurrentUserXnId() != NO_USER && DataStorage::GetInstance().IsUserPose(DataStorage::GetInstance().GetCurrentUserXnId() - 1)) {
+    if(DataStorage::GetInstance().GetCurrentUserXnId() != NO_USER && DataStorage::GetInstance().IsUserPose(DataStorage::GetInstance().GetCurrentUserXnId())) {
         AwaitingStateEnter();
     }
     else if(DataStorage::GetInstance().GetCurrentUserXnId() == NO_USER) {
-        WaitingStateEnter();
+        //Short occlusions are coasted through, mobility follows predicted position meanwhile
+        if(!DataStorage::GetInstance().IsFollowedUserTracked() ||
+                DataStorage::GetInstance().GetTimeSinceFollowedUserSeen() >= occlusionCoastTime) {
+            WaitingStateEnter();
+        }
     }
 }
 
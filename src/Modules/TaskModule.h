@@ -5,6 +5,7 @@
 #define DEFAULT_WAIT_TIME_LIMIT 5.0
 #define DEFAULT_SEARCH_TIME_LIMIT 10.0
 #define DEFAULT_MAX_USER_DISTANCE 4000.0
+#define DEFAULT_OCCLUSION_COAST_TIME 0.5
 
 #include <ros/ros.h>
 #include <ros/package.h>
@@ -35,6 +36,7 @@ private:
     double waitTimeLimit;
     double searchTimeLimit;
     double maxUserDistance;
+    double occlusionCoastTime;
     double timeElapsed;
 
     TaskModule() {}
@@ -0,0 +1,230 @@
+#include "TrackerModule.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool TrackerModule::Initialize(ros::NodeHandle* nodeHandlePrivate) {
+    int _logLevel;
+    if(!nodeHandlePrivate->getParam("trackerModuleLogLevel", _logLevel)) {
+        ROS_WARN("TrackerModule: Log level not found, using default");
+        logLevel = DEFAULT_TRACKER_MODULE_LOG_LEVEL;
+    }
+    else {
+        switch (_logLevel) {
+            case 0:
+                logLevel = Debug;
+                break;
+            case 1:
+                logLevel = Info;
+                break;
+            case 2:
+                logLevel = Warn;
+                break;
+            case 3:
+                logLevel = Error;
+                break;
+            default:
+                ROS_WARN("TrackerModule: Requested invalid log level, using default");
+                logLevel = DEFAULT_TRACKER_MODULE_LOG_LEVEL;
+                break;
+        }
+    }
+    if(!nodeHandlePrivate->getParam("trackerGateDistance", gateDistance)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TrackerModule: Value of trackerGateDistance not found, using default: %f", DEFAULT_TRACKER_GATE_DISTANCE);
+        }
+        gateDistance = DEFAULT_TRACKER_GATE_DISTANCE;
+    }
+    if(!nodeHandlePrivate->getParam("trackerTimeout", timeout)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TrackerModule: Value of trackerTimeout not found, using default: %f", DEFAULT_TRACKER_TIMEOUT);
+        }
+        timeout = DEFAULT_TRACKER_TIMEOUT;
+    }
+    if(!nodeHandlePrivate->getParam("trackerHeightWeight", heightWeight)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TrackerModule: Value of trackerHeightWeight not found, using default: %f", DEFAULT_TRACKER_HEIGHT_WEIGHT);
+        }
+        heightWeight = DEFAULT_TRACKER_HEIGHT_WEIGHT;
+    }
+    if(!nodeHandlePrivate->getParam("trackProcessNoise", processNoise)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TrackerModule: Value of trackProcessNoise not found, using default: %f", DEFAULT_TRACK_PROCESS_NOISE);
+        }
+        processNoise = DEFAULT_TRACK_PROCESS_NOISE;
+    }
+    if(!nodeHandlePrivate->getParam("trackMeasurementNoise", measurementNoise)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("TrackerModule: Value of trackMeasurementNoise not found, using default: %f", DEFAULT_TRACK_MEASUREMENT_NOISE);
+        }
+        measurementNoise = DEFAULT_TRACK_MEASUREMENT_NOISE;
+    }
+    int maxUsers = DataStorage::GetInstance().GetMaxUsers();
+    //Lost tracks are kept until timeout, so there may be more tracks than users
+    int maxTracks = 2*maxUsers;
+    tracks.clear();
+    tracks.reserve(maxTracks);
+    userTracks.assign(maxUsers, NO_TRACK);
+    candidates.reserve(maxUsers);
+    candidatePositions.reserve(maxUsers);
+    candidateMatched.reserve(maxUsers);
+    costs.reserve(maxTracks*maxTracks);
+    assignment.reserve(maxTracks);
+    solver.Reserve(maxTracks);
+    nextTrackId = NO_TRACK + 1;
+    lastFrameId = 0;
+    idSwaps = 0;
+    createdTracks = 0;
+    if(logLevel <= Info) {
+        ROS_INFO("TrackerModule: Initialized");
+    }
+    return true;
+}
+
+void TrackerModule::Update() {
+    const SkeletonFrame& frame = SensorsModule::GetInstance().GetFrame();
+    if(frame.frameId == lastFrameId) {
+        return;
+    }
+    lastFrameId = frame.frameId;
+    double timestamp = frame.timestamp;
+    DataStorage& dataStorage = DataStorage::GetInstance();
+    candidates.clear();
+    candidatePositions.clear();
+    dataStorage.GetUserTable().ForEachPresent([&](XnUserID userId) {
+        XnPoint3D position = dataStorage.GetUserCoM(userId);
+        if(position.Z > 1.0) {
+            candidates.push_back(userId);
+            candidatePositions.push_back(position);
+        }
+    });
+    //Square matrix, padding rows and columns cost gate distance and stand for unmatched track or user
+    int size = std::max(tracks.size(), candidates.size());
+    costs.assign(size*size, gateDistance);
+    for(int i=0; i < tracks.size(); ++i) {
+        for(int j=0; j < candidates.size(); ++j) {
+            costs[i*size + j] = std::min(Distance(tracks[i], candidatePositions[j], timestamp), 2.0*gateDistance);
+        }
+    }
+    assignment.resize(size);
+    if(size > 0) {
+        solver.Solve(costs.data(), size, assignment.data());
+    }
+    std::fill(userTracks.begin(), userTracks.end(), NO_TRACK);
+    candidateMatched.assign(candidates.size(), 0);
+    for(int i=0; i < tracks.size(); ++i) {
+        int j = assignment[i];
+        if(j >= candidates.size() || costs[i*size + j] >= gateDistance) {
+            continue;
+        }
+        PersonTrack& track = tracks[i];
+        XnUserID userId = candidates[j];
+        if(track.userId != userId) {
+            ++idSwaps;
+            if(logLevel <= Info) {
+                ROS_INFO("TrackerModule: Track %lu moved from user %d to user %d", track.id, track.userId, userId);
+            }
+            track.userId = userId;
+        }
+        UserTrack& motion = track.motion;
+        double timeStep = timestamp - motion.lastUpdate;
+        motion.x.Predict(timeStep, processNoise);
+        motion.z.Predict(timeStep, processNoise);
+        motion.x.Update(candidatePositions[j].X, measurementNoise);
+        motion.z.Update(candidatePositions[j].Z, measurementNoise);
+        motion.y = candidatePositions[j].Y;
+        motion.lastUpdate = timestamp;
+        userTracks[userId-1] = track.id;
+        candidateMatched[j] = 1;
+    }
+    //Tracks not seen for timeout are dropped, order of remaining ones is kept
+    int kept = 0;
+    for(int i=0; i < tracks.size(); ++i) {
+        if(timestamp - tracks[i].motion.lastUpdate <= timeout) {
+            tracks[kept++] = tracks[i];
+        }
+        else if(logLevel <= Debug) {
+            ROS_DEBUG("TrackerModule: Track %lu dropped", tracks[i].id);
+        }
+    }
+    tracks.resize(kept);
+    for(int j=0; j < candidates.size(); ++j) {
+        if(!candidateMatched[j]) {
+            CreateTrack(candidates[j], candidatePositions[j], timestamp);
+        }
+    }
+}
+
+void TrackerModule::Finish() {
+    if(logLevel <= Info) {
+        ROS_INFO("TrackerModule: Tracks created: %lu, user id changes: %lu", createdTracks, idSwaps);
+    }
+}
+
+unsigned long TrackerModule::GetTrackId(XnUserID userId) {
+    if(userId < 1 || userId > userTracks.size()) {
+        return NO_TRACK;
+    }
+    return userTracks[userId-1];
+}
+
+XnUserID TrackerModule::GetUserOfTrack(unsigned long trackId) {
+    for(int i=0; i < tracks.size(); ++i) {
+        if(tracks[i].id == trackId) {
+            return userTracks[tracks[i].userId-1] == trackId ? tracks[i].userId : NO_USER;
+        }
+    }
+    return NO_USER;
+}
+
+bool TrackerModule::IsTrackAlive(unsigned long trackId) {
+    for(int i=0; i < tracks.size(); ++i) {
+        if(tracks[i].id == trackId) {
+            return true;
+        }
+    }
+    return false;
+}
+
+UserTrack const* TrackerModule::GetMotionOfUser(XnUserID userId) {
+    unsigned long trackId = GetTrackId(userId);
+    if(trackId == NO_TRACK) {
+        return NULL;
+    }
+    for(int i=0; i < tracks.size(); ++i) {
+        if(tracks[i].id == trackId) {
+            return &tracks[i].motion;
+        }
+    }
+    return NULL;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+double TrackerModule::Distance(PersonTrack const& track, XnPoint3D const& position, double timestamp) {
+    UserTrack const& motion = track.motion;
+    double timeStep = timestamp - motion.lastUpdate;
+    double xDistance = motion.x.PredictPosition(timeStep) - position.X;
+    double zDistance = motion.z.PredictPosition(timeStep) - position.Z;
+    return sqrt(xDistance*xDistance + zDistance*zDistance) + heightWeight*fabs(motion.y - position.Y);
+}
+
+void TrackerModule::CreateTrack(XnUserID userId, XnPoint3D const& position, double timestamp) {
+    PersonTrack track;
+    track.id = nextTrackId++;
+    track.userId = userId;
+    track.motion.x.Reset(position.X, TRACK_INITIAL_POSITION_VARIANCE, TRACK_INITIAL_VELOCITY_VARIANCE);
+    track.motion.z.Reset(position.Z, TRACK_INITIAL_POSITION_VARIANCE, TRACK_INITIAL_VELOCITY_VARIANCE);
+    track.motion.y = position.Y;
+    track.motion.lastUpdate = timestamp;
+    track.motion.initialized = true;
+    tracks.push_back(track);
+    userTracks[userId-1] = track.id;
+    ++createdTracks;
+    if(logLevel <= Debug) {
+        ROS_DEBUG("TrackerModule: Track %lu created for user %d", track.id, userId);
+    }
+}
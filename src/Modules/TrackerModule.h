@@ -0,0 +1,75 @@
+#ifndef ELEKTRON_ESCORT_TRACKER_MODULE_H
+#define ELEKTRON_ESCORT_TRACKER_MODULE_H
+
+#define DEFAULT_TRACKER_MODULE_LOG_LEVEL Info
+#define DEFAULT_TRACKER_GATE_DISTANCE 700.0
+#define DEFAULT_TRACKER_TIMEOUT 1.0
+#define DEFAULT_TRACKER_HEIGHT_WEIGHT 1.0
+#define DEFAULT_TRACK_PROCESS_NOISE 1000000.0
+#define DEFAULT_TRACK_MEASUREMENT_NOISE 2500.0
+#define TRACK_INITIAL_POSITION_VARIANCE 10000.0
+#define TRACK_INITIAL_VELOCITY_VARIANCE 1000000.0
+#define NO_TRACK 0
+
+#include <vector>
+#include <ros/ros.h>
+#include <XnCppWrapper.h>
+#include "../Common.h"
+#include "DataStorage.h"
+#include "SensorsModule.h"
+#include "../Utilities/HungarianAssignment.h"
+
+
+struct PersonTrack {
+    unsigned long id;
+    XnUserID userId;
+    UserTrack motion;
+};
+
+//Associates NITE users with persistent tracks across frames by global assignment
+//over predicted position and center of mass height, so swapped or reissued ids keep their person.
+//Tracks are the only motion filter of users, DataStorage predicts from them.
+class TrackerModule {
+public:
+    static TrackerModule& GetInstance() {
+        static TrackerModule instance;
+        return instance;
+    }
+    bool Initialize(ros::NodeHandle* nodeHandlePrivate);
+    void Update();
+    void Finish();
+    unsigned long GetTrackId(XnUserID userId);
+    XnUserID GetUserOfTrack(unsigned long trackId);
+    bool IsTrackAlive(unsigned long trackId);
+    //Motion of track matched to user in current frame, NULL when user has none
+    UserTrack const* GetMotionOfUser(XnUserID userId);
+
+private:
+    LogLevels logLevel;
+    double gateDistance;
+    double timeout;
+    double heightWeight;
+    double processNoise;
+    double measurementNoise;
+    unsigned long nextTrackId;
+    unsigned long lastFrameId;
+    unsigned long idSwaps;
+    unsigned long createdTracks;
+    std::vector<PersonTrack> tracks;
+    std::vector<unsigned long> userTracks;
+    std::vector<XnUserID> candidates;
+    std::vector<XnPoint3D> candidatePositions;
+    std::vector<double> costs;
+    std::vector<int> assignment;
+    std::vector<char> candidateMatched;
+    HungarianAssignment solver;
+
+    TrackerModule() {}
+    TrackerModule(const TrackerModule &);
+    TrackerModule& operator=(const TrackerModule&);
+    ~TrackerModule() {}
+    double Distance(PersonTrack const& track, XnPoint3D const& position, double timestamp);
+    void CreateTrack(XnUserID userId, XnPoint3D const& position, double timestamp);
+};
+
+#endif //ELEKTRON_ESCORT_TRACKER_MODULE_H
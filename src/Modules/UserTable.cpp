@@ -0,0 +1,81 @@
+#include "UserTable.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void UserTable::Resize(int newCapacity) {
+    capacity = newCapacity;
+    presence.resize((capacity + USER_TABLE_WORD_BITS - 1)/USER_TABLE_WORD_BITS);
+    records.resize(capacity);
+    Clear();
+}
+
+void UserTable::Clear() {
+    std::fill(presence.begin(), presence.end(), 0);
+    for(int i=0; i < records.size(); ++i) {
+        records[i].centerOfMass.X = 0.0f;
+        records[i].centerOfMass.Y = 0.0f;
+        records[i].centerOfMass.Z = 0.0f;
+        records[i].velocity = records[i].centerOfMass;
+        records[i].centerOfMassFrameId = 0;
+        records[i].lastSeen = 0.0;
+        records[i].poseCooldownExpiry = 0.0;
+        records[i].poseTick = 0;
+    }
+    count = 0;
+}
+
+int UserTable::GetCapacity() const {
+    return capacity;
+}
+
+int UserTable::GetCount() const {
+    return count;
+}
+
+bool UserTable::IsValid(XnUserID userId) const {
+    return userId >= 1 && userId <= capacity;
+}
+
+bool UserTable::IsPresent(XnUserID userId) const {
+    if(!IsValid(userId)) {
+        return false;
+    }
+    int index = userId - 1;
+    return (presence[index/USER_TABLE_WORD_BITS] >> (index%USER_TABLE_WORD_BITS)) & 1;
+}
+
+void UserTable::Insert(XnUserID userId) {
+    if(!IsValid(userId) || IsPresent(userId)) {
+        return;
+    }
+    int index = userId - 1;
+    presence[index/USER_TABLE_WORD_BITS] |= (uint64_t)1 << (index%USER_TABLE_WORD_BITS);
+    ++count;
+}
+
+void UserTable::Erase(XnUserID userId) {
+    if(!IsPresent(userId)) {
+        return;
+    }
+    int index = userId - 1;
+    presence[index/USER_TABLE_WORD_BITS] &= ~((uint64_t)1 << (index%USER_TABLE_WORD_BITS));
+    --count;
+}
+
+UserRecord& UserTable::Get(XnUserID userId) {
+    return records[userId-1];
+}
+
+UserRecord const& UserTable::Get(XnUserID userId) const {
+    return records[userId-1];
+}
+
+int UserTable::GetPresentUsers(XnUserID* userIds) const {
+    int index = 0;
+    ForEachPresent([&](XnUserID userId) {
+        userIds[index++] = userId;
+    });
+    return index;
+}
@@ -0,0 +1,57 @@
+#ifndef ELEKTRON_ESCORT_USER_TABLE_H
+#define ELEKTRON_ESCORT_USER_TABLE_H
+
+#define USER_TABLE_WORD_BITS 64
+
+#include <vector>
+#include <cstdint>
+#include <XnCppWrapper.h>
+#include "../Common.h"
+
+
+struct UserRecord {
+    XnPoint3D centerOfMass;
+    XnPoint3D velocity;
+    unsigned long centerOfMassFrameId;
+    double lastSeen;
+    double poseCooldownExpiry;
+    unsigned long poseTick;
+};
+
+//Fixed capacity table of per-user state with slots indexed by userId-1.
+//Presence is kept in bitmask, so iterating present users scans only set bits.
+//Iteration works on a copy of each mask word, so visited user may be erased from callback.
+class UserTable {
+public:
+    void Resize(int newCapacity);
+    void Clear();
+    int GetCapacity() const;
+    int GetCount() const;
+    bool IsValid(XnUserID userId) const;
+    bool IsPresent(XnUserID userId) const;
+    void Insert(XnUserID userId);
+    void Erase(XnUserID userId);
+    UserRecord& Get(XnUserID userId);
+    UserRecord const& Get(XnUserID userId) const;
+    int GetPresentUsers(XnUserID* userIds) const;
+
+    template<typename Function>
+    void ForEachPresent(Function function) const {
+        for(int word=0; word < presence.size(); ++word) {
+            uint64_t bits = presence[word];
+            while(bits != 0) {
+                int bit = __builtin_ctzll(bits);
+                bits &= bits - 1;
+                function((XnUserID)(word*USER_TABLE_WORD_BITS + bit + 1));
+            }
+        }
+    }
+
+private:
+    int capacity = 0;
+    int count = 0;
+    std::vector<uint64_t> presence;
+    std::vector<UserRecord> records;
+};
+
+#endif //ELEKTRON_ESCORT_USER_TABLE_H
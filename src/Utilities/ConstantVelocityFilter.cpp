@@ -0,0 +1,60 @@
+#include "ConstantVelocityFilter.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ConstantVelocityFilter::Reset(double _position, double positionVariance, double velocityVariance) {
+    position = _position;
+    velocity = 0.0;
+    p00 = positionVariance;
+    p01 = 0.0;
+    p11 = velocityVariance;
+}
+
+void ConstantVelocityFilter::Predict(double timeStep, double processNoise) {
+    if(timeStep <= 0.0) {
+        return;
+    }
+    double dt = timeStep;
+    double dt2 = dt*dt;
+    position += velocity*dt;
+    //P = F P F' + Q, with Q of discretized white acceleration
+    double newP00 = p00 + 2.0*dt*p01 + dt2*p11 + processNoise*dt2*dt/3.0;
+    double newP01 = p01 + dt*p11 + processNoise*dt2/2.0;
+    double newP11 = p11 + processNoise*dt;
+    p00 = newP00;
+    p01 = newP01;
+    p11 = newP11;
+}
+
+void ConstantVelocityFilter::Update(double measurement, double measurementNoise) {
+    double innovation = measurement - position;
+    double innovationVariance = p00 + measurementNoise;
+    double gain0 = p00/innovationVariance;
+    double gain1 = p01/innovationVariance;
+    position += gain0*innovation;
+    velocity += gain1*innovation;
+    double newP00 = (1.0 - gain0)*p00;
+    double newP01 = (1.0 - gain0)*p01;
+    double newP11 = p11 - gain1*p01;
+    p00 = newP00;
+    p01 = newP01;
+    p11 = newP11;
+}
+
+double ConstantVelocityFilter::GetPosition() const {
+    return position;
+}
+
+double ConstantVelocityFilter::GetVelocity() const {
+    return velocity;
+}
+
+double ConstantVelocityFilter::GetPositionVariance() const {
+    return p00;
+}
+
+double ConstantVelocityFilter::PredictPosition(double timeStep) const {
+    return position + velocity*timeStep;
+}
@@ -0,0 +1,25 @@
+#ifndef ELEKTRON_ESCORT_CONSTANT_VELOCITY_FILTER_H
+#define ELEKTRON_ESCORT_CONSTANT_VELOCITY_FILTER_H
+
+
+//Kalman filter of one coordinate with state [position, velocity] and constant velocity model.
+//Process noise is spectral density of white acceleration, measurement noise is position variance.
+class ConstantVelocityFilter {
+public:
+    void Reset(double position, double positionVariance, double velocityVariance);
+    void Predict(double timeStep, double processNoise);
+    void Update(double measurement, double measurementNoise);
+    double GetPosition() const;
+    double GetVelocity() const;
+    double GetPositionVariance() const;
+    double PredictPosition(double timeStep) const;
+
+private:
+    double position = 0.0;
+    double velocity = 0.0;
+    double p00 = 0.0;
+    double p01 = 0.0;
+    double p11 = 0.0;
+};
+
+#endif //ELEKTRON_ESCORT_CONSTANT_VELOCITY_FILTER_H
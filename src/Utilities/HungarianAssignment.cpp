@@ -0,0 +1,69 @@
+#include "HungarianAssignment.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void HungarianAssignment::Reserve(int size) {
+    rowPotential.reserve(size + 1);
+    columnPotential.reserve(size + 1);
+    minimum.reserve(size + 1);
+    columnMatch.reserve(size + 1);
+    way.reserve(size + 1);
+    used.reserve(size + 1);
+}
+
+double HungarianAssignment::Solve(double const* costs, int size, int* rowAssignment) {
+    //Shortest augmenting path with potentials, rows and columns are indexed from 1, column 0 is virtual
+    const double infinity = std::numeric_limits<double>::infinity();
+    rowPotential.assign(size + 1, 0.0);
+    columnPotential.assign(size + 1, 0.0);
+    columnMatch.assign(size + 1, 0);
+    way.assign(size + 1, 0);
+    for(int row=1; row <= size; ++row) {
+        columnMatch[0] = row;
+        int column0 = 0;
+        minimum.assign(size + 1, infinity);
+        used.assign(size + 1, 0);
+        do {
+            used[column0] = 1;
+            int row0 = columnMatch[column0];
+            double delta = infinity;
+            int column1 = 0;
+            for(int column=1; column <= size; ++column) {
+                if(!used[column]) {
+                    double reduced = costs[(row0 - 1)*size + column - 1] - rowPotential[row0] - columnPotential[column];
+                    if(reduced < minimum[column]) {
+                        minimum[column] = reduced;
+                        way[column] = column0;
+                    }
+                    if(minimum[column] < delta) {
+                        delta = minimum[column];
+                        column1 = column;
+                    }
+                }
+            }
+            for(int column=0; column <= size; ++column) {
+                if(used[column]) {
+                    rowPotential[columnMatch[column]] += delta;
+                    columnPotential[column] -= delta;
+                }
+                else {
+                    minimum[column] -= delta;
+                }
+            }
+            column0 = column1;
+        } while(columnMatch[column0] != 0);
+        do {
+            int column1 = way[column0];
+            columnMatch[column0] = columnMatch[column1];
+            column0 = column1;
+        } while(column0 != 0);
+    }
+    double total = 0.0;
+    for(int column=1; column <= size; ++column) {
+        rowAssignment[columnMatch[column] - 1] = column - 1;
+        total += costs[(columnMatch[column] - 1)*size + column - 1];
+    }
+    return total;
+}
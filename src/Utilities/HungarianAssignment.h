@@ -0,0 +1,24 @@
+#ifndef ELEKTRON_ESCORT_HUNGARIAN_ASSIGNMENT_H
+#define ELEKTRON_ESCORT_HUNGARIAN_ASSIGNMENT_H
+
+#include <vector>
+#include <limits>
+
+
+//Minimum cost assignment of square cost matrix (row-major) in O(n^3).
+//Buffers are kept between calls, so solving matrices up to reserved size does not allocate.
+class HungarianAssignment {
+public:
+    void Reserve(int size);
+    double Solve(double const* costs, int size, int* rowAssignment);
+
+private:
+    std::vector<double> rowPotential;
+    std::vector<double> columnPotential;
+    std::vector<double> minimum;
+    std::vector<int> columnMatch;
+    std::vector<int> way;
+    std::vector<char> used;
+};
+
+#endif //ELEKTRON_ESCORT_HUNGARIAN_ASSIGNMENT_H
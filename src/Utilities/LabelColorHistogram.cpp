@@ -0,0 +1,49 @@
+#include "LabelColorHistogram.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LabelColorHistogram::Accumulate(unsigned short const* labels, unsigned char const* rgb, int width, int height, int step,
+                                     int const* splitRows, int maxLabel, float* histograms) {
+    int histogramSize = COLOR_HISTOGRAM_REGIONS*COLOR_HISTOGRAM_BINS;
+    int columns = (width + step - 1)/step;
+    rowBins.resize(columns);
+    counts.assign(maxLabel*histogramSize, 0);
+    for(int y=0; y < height; y += step) {
+        unsigned short const* labelRow = labels + y*width;
+        //Bins are computed for whole row first, so this part does not depend on labels and vectorizes
+        QuantizeRow(rgb + 3*y*width, columns, step, rowBins.data());
+        for(int column=0; column < columns; ++column) {
+            unsigned short label = labelRow[column*step];
+            if(label == 0 || label > maxLabel) {
+                continue;
+            }
+            int region = y < splitRows[label-1] ? CR_Upper : CR_Lower;
+            ++counts[(label-1)*histogramSize + region*COLOR_HISTOGRAM_BINS + rowBins[column]];
+        }
+    }
+    for(int i=0; i < maxLabel*COLOR_HISTOGRAM_REGIONS; ++i) {
+        unsigned int const* regionCounts = &counts[i*COLOR_HISTOGRAM_BINS];
+        float* regionHistogram = histograms + i*COLOR_HISTOGRAM_BINS;
+        unsigned int total = 0;
+        for(int bin=0; bin < COLOR_HISTOGRAM_BINS; ++bin) {
+            total += regionCounts[bin];
+        }
+        float scale = total > 0 ? 1.0f/total : 0.0f;
+        for(int bin=0; bin < COLOR_HISTOGRAM_BINS; ++bin) {
+            regionHistogram[bin] = regionCounts[bin]*scale;
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LabelColorHistogram::QuantizeRow(unsigned char const* __restrict__ rgb, int pixels, int step, unsigned char* __restrict__ bins) {
+    for(int i=0; i < pixels; ++i) {
+        unsigned char const* pixel = rgb + 3*i*step;
+        bins[i] = ((pixel[0] >> 6) << 4) | ((pixel[1] >> 6) << 2) | (pixel[2] >> 6);
+    }
+}
@@ -0,0 +1,31 @@
+#ifndef ELEKTRON_ESCORT_LABEL_COLOR_HISTOGRAM_H
+#define ELEKTRON_ESCORT_LABEL_COLOR_HISTOGRAM_H
+
+#define COLOR_HISTOGRAM_BINS 64
+#define COLOR_HISTOGRAM_REGIONS 2
+
+#include <vector>
+#include <algorithm>
+
+
+enum ColorRegions {
+    CR_Upper, CR_Lower
+};
+
+//Color histograms of all labeled users built in one pass over label and RGB maps.
+//Every channel is quantized to 2 bits, giving 4x4x4 bins. Rows above user's split row belong
+//to upper region, remaining rows to lower one. Histograms of every region are normalized to sum 1,
+//regions without pixels stay zero. Output holds COLOR_HISTOGRAM_REGIONS*COLOR_HISTOGRAM_BINS floats per label.
+class LabelColorHistogram {
+public:
+    void Accumulate(unsigned short const* labels, unsigned char const* rgb, int width, int height, int step,
+                    int const* splitRows, int maxLabel, float* histograms);
+
+private:
+    std::vector<unsigned char> rowBins;
+    std::vector<unsigned int> counts;
+
+    static void QuantizeRow(unsigned char const* rgb, int pixels, int step, unsigned char* bins);
+};
+
+#endif //ELEKTRON_ESCORT_LABEL_COLOR_HISTOGRAM_H
@@ -0,0 +1,72 @@
+#include "LabelDepthReduction.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LabelDepthReduction::Reduce(unsigned short const* labels, unsigned short const* depth, int width, int height, int maxLabel,
+                                 LabelDepthStatistics* statistics) {
+    for(int i=0; i < maxLabel; ++i) {
+        LabelDepthStatistics& label = statistics[i];
+        label.pixels = 0;
+        label.depthPixels = 0;
+        label.left = width;
+        label.top = height;
+        label.right = -1;
+        label.bottom = -1;
+        label.minDepth = 0xFFFF;
+        label.maxDepth = 0;
+        label.depthSum = 0;
+        label.xSum = 0;
+        label.ySum = 0;
+    }
+    for(int y=0; y < height; ++y) {
+        unsigned short const* labelRow = labels + y*width;
+        unsigned short const* depthRow = depth + y*width;
+        int x = 0;
+        while(x < width) {
+            unsigned short value = labelRow[x];
+            int start = x;
+            while(x < width && labelRow[x] == value) {
+                ++x;
+            }
+            if(value == 0 || value > maxLabel) {
+                continue;
+            }
+            LabelDepthStatistics& label = statistics[value-1];
+            int length = x - start;
+            label.pixels += length;
+            label.left = std::min(label.left, start);
+            label.right = std::max(label.right, x - 1);
+            label.top = std::min(label.top, y);
+            label.bottom = std::max(label.bottom, y);
+            label.xSum += (unsigned long long)length*(start + x - 1)/2;
+            label.ySum += (unsigned long long)length*y;
+            ReduceRun(depthRow + start, length, label.depthPixels, label.minDepth, label.maxDepth, label.depthSum);
+        }
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LabelDepthReduction::ReduceRun(unsigned short const* __restrict__ depth, int length, unsigned int& depthPixels,
+                                    unsigned int& minDepth, unsigned int& maxDepth, unsigned long long& depthSum) {
+    //Branch free integer loop, vectorized by the compiler. Unknown depth is masked out of min by maximal value.
+    unsigned int known = 0;
+    unsigned int runMin = 0xFFFF;
+    unsigned int runMax = 0;
+    unsigned int sum = 0;
+    for(int i=0; i < length; ++i) {
+        unsigned int value = depth[i];
+        known += value != 0;
+        runMin = std::min(runMin, value != 0 ? value : 0xFFFFu);
+        runMax = std::max(runMax, value);
+        sum += value;
+    }
+    depthPixels += known;
+    minDepth = std::min(minDepth, runMin);
+    maxDepth = std::max(maxDepth, runMax);
+    depthSum += sum;
+}
@@ -0,0 +1,36 @@
+#ifndef ELEKTRON_ESCORT_LABEL_DEPTH_REDUCTION_H
+#define ELEKTRON_ESCORT_LABEL_DEPTH_REDUCTION_H
+
+#include <vector>
+#include <algorithm>
+
+
+//Pixel statistics of one label, in depth map coordinates. Depth values of 0 are unknown depth,
+//they count as pixels of the label but not into depth statistics.
+struct LabelDepthStatistics {
+    unsigned int pixels;
+    unsigned int depthPixels;
+    int left;
+    int top;
+    int right;
+    int bottom;
+    unsigned int minDepth;
+    unsigned int maxDepth;
+    unsigned long long depthSum;
+    unsigned long long xSum;
+    unsigned long long ySum;
+};
+
+//Statistics of all labels gathered in one pass over label and depth maps. Rows are walked as runs
+//of equal labels, so per-pixel work is plain min, max and sum over contiguous depth values.
+class LabelDepthReduction {
+public:
+    void Reduce(unsigned short const* labels, unsigned short const* depth, int width, int height, int maxLabel,
+                LabelDepthStatistics* statistics);
+
+private:
+    static void ReduceRun(unsigned short const* depth, int length, unsigned int& depthPixels,
+                          unsigned int& minDepth, unsigned int& maxDepth, unsigned long long& depthSum);
+};
+
+#endif //ELEKTRON_ESCORT_LABEL_DEPTH_REDUCTION_H
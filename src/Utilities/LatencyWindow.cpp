@@ -0,0 +1,85 @@
+#include "LatencyWindow.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LatencyWindow::Resize(int capacity) {
+    samples.assign(std::max(capacity, 1), 0.0);
+    sorted.reserve(samples.size());
+    Clear();
+}
+
+void LatencyWindow::Clear() {
+    next = 0;
+    count = 0;
+    totalCount = 0;
+    maxEver = 0.0;
+    sortedValid = false;
+}
+
+void LatencyWindow::Record(double seconds) {
+    samples[next] = seconds;
+    next = (next + 1) % samples.size();
+    if(count < samples.size()) {
+        ++count;
+    }
+    ++totalCount;
+    if(seconds > maxEver) {
+        maxEver = seconds;
+    }
+    sortedValid = false;
+}
+
+int LatencyWindow::GetCount() {
+    return count;
+}
+
+unsigned long LatencyWindow::GetTotalCount() {
+    return totalCount;
+}
+
+double LatencyWindow::GetPercentile(double percentile) {
+    if(count == 0) {
+        return 0.0;
+    }
+    Sort();
+    int index = (int)(percentile*(count - 1) + 0.5);
+    return sorted[std::max(0, std::min(index, count - 1))];
+}
+
+double LatencyWindow::GetMax() {
+    if(count == 0) {
+        return 0.0;
+    }
+    Sort();
+    return sorted[count - 1];
+}
+
+double LatencyWindow::GetMean() {
+    if(count == 0) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for(int i=0; i < count; ++i) {
+        sum += samples[i];
+    }
+    return sum/count;
+}
+
+double LatencyWindow::GetMaxEver() {
+    return maxEver;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void LatencyWindow::Sort() {
+    if(sortedValid) {
+        return;
+    }
+    sorted.assign(samples.begin(), samples.begin() + count);
+    std::sort(sorted.begin(), sorted.end());
+    sortedValid = true;
+}
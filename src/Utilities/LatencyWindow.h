@@ -0,0 +1,34 @@
+#ifndef ELEKTRON_ESCORT_LATENCY_WINDOW_H
+#define ELEKTRON_ESCORT_LATENCY_WINDOW_H
+
+#include <vector>
+#include <algorithm>
+
+
+//Rolling window of the most recent durations with percentile queries.
+//Recording is O(1), percentiles are computed on demand from a copy of the window.
+class LatencyWindow {
+public:
+    void Resize(int capacity);
+    void Clear();
+    void Record(double seconds);
+    int GetCount();
+    unsigned long GetTotalCount();
+    double GetPercentile(double percentile);
+    double GetMax();
+    double GetMean();
+    double GetMaxEver();
+
+private:
+    std::vector<double> samples;
+    std::vector<double> sorted;
+    int next = 0;
+    int count = 0;
+    unsigned long totalCount = 0;
+    double maxEver = 0.0;
+    bool sortedValid = false;
+
+    void Sort();
+};
+
+#endif //ELEKTRON_ESCORT_LATENCY_WINDOW_H
@@ -0,0 +1,57 @@
+#include "OneEuroFilter.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void OneEuroFilter::Resize(int size) {
+    previousValues.resize(size);
+    previousDerivatives.resize(size);
+    initialized.resize(size);
+    Reset();
+}
+
+void OneEuroFilter::Reset() {
+    std::fill(previousValues.begin(), previousValues.end(), 0.0f);
+    std::fill(previousDerivatives.begin(), previousDerivatives.end(), 0.0f);
+    std::fill(initialized.begin(), initialized.end(), 0.0f);
+}
+
+void OneEuroFilter::SetParameters(double _minCutoff, double _beta, double _derivativeCutoff) {
+    minCutoff = _minCutoff;
+    beta = _beta;
+    derivativeCutoff = _derivativeCutoff;
+}
+
+void OneEuroFilter::Filter(float* __restrict__ values, float const* __restrict__ active, double timeStep) {
+    float* __restrict__ previous = previousValues.data();
+    float* __restrict__ previousDerivative = previousDerivatives.data();
+    float* __restrict__ started = initialized.data();
+    float step = timeStep;
+    float derivativeAlpha = Alpha(derivativeCutoff, step);
+    float twoPiStep = 2.0f*(float)M_PI*step;
+    int size = previousValues.size();
+    //Branch free pass over all signals, vectorized by the compiler. First sample of a signal passes through.
+    for(int i=0; i < size; ++i) {
+        float value = values[i];
+        float derivative = started[i]*(value - previous[i])/step;
+        float smoothedDerivative = previousDerivative[i] + derivativeAlpha*(derivative - previousDerivative[i]);
+        float cutoff = minCutoff + beta*std::fabs(smoothedDerivative);
+        float alpha = twoPiStep*cutoff/(1.0f + twoPiStep*cutoff);
+        alpha = started[i] > 0.0f ? alpha : 1.0f;
+        float filtered = previous[i] + alpha*(value - previous[i]);
+        values[i] = active[i] > 0.0f ? filtered : value;
+        previous[i] = active[i]*filtered;
+        previousDerivative[i] = active[i]*started[i]*smoothedDerivative;
+        started[i] = active[i];
+    }
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+float OneEuroFilter::Alpha(float cutoff, float timeStep) {
+    float twoPiStep = 2.0f*(float)M_PI*timeStep*cutoff;
+    return twoPiStep/(1.0f + twoPiStep);
+}
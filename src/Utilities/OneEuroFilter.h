@@ -0,0 +1,30 @@
+#ifndef ELEKTRON_ESCORT_ONE_EURO_FILTER_H
+#define ELEKTRON_ESCORT_ONE_EURO_FILTER_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+
+//Bank of independent One-Euro low-pass filters over contiguous array of signals.
+//Cutoff grows with filtered speed of the signal: still signals are smoothed strongly, moving ones follow
+//with little lag. Signals with active equal 0 are left unchanged and start over once active again.
+class OneEuroFilter {
+public:
+    void Resize(int size);
+    void Reset();
+    void SetParameters(double minCutoff, double beta, double derivativeCutoff);
+    void Filter(float* values, float const* active, double timeStep);
+
+private:
+    std::vector<float> previousValues;
+    std::vector<float> previousDerivatives;
+    std::vector<float> initialized;
+    float minCutoff = 1.0f;
+    float beta = 0.0f;
+    float derivativeCutoff = 1.0f;
+
+    static float Alpha(float cutoff, float timeStep);
+};
+
+#endif //ELEKTRON_ESCORT_ONE_EURO_FILTER_H
@@ -0,0 +1,83 @@
+#include "RollingStatistics.h"
+#include <cmath>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RollingStatistics::Resize(int capacity) {
+    samples.assign(std::max(capacity, 1), 0.0);
+    Clear();
+}
+
+void RollingStatistics::Clear() {
+    next = 0;
+    count = 0;
+    pushesSinceRecompute = 0;
+    sum = 0.0;
+    sumOfSquares = 0.0;
+}
+
+void RollingStatistics::Push(double sample) {
+    if(count == samples.size()) {
+        double oldest = samples[next];
+        sum -= oldest;
+        sumOfSquares -= oldest*oldest;
+    }
+    else {
+        ++count;
+    }
+    samples[next] = sample;
+    sum += sample;
+    sumOfSquares += sample*sample;
+    next = (next + 1) % samples.size();
+    //Subtracting evicted samples accumulates rounding error, sums are rebuilt once per window
+    if(++pushesSinceRecompute >= samples.size()) {
+        Recompute();
+    }
+}
+
+int RollingStatistics::GetCount() const {
+    return count;
+}
+
+int RollingStatistics::GetCapacity() const {
+    return samples.size();
+}
+
+bool RollingStatistics::IsFull() const {
+    return count == samples.size();
+}
+
+double RollingStatistics::GetMean() const {
+    if(count == 0) {
+        return 0.0;
+    }
+    return sum/count;
+}
+
+double RollingStatistics::GetVariance() const {
+    if(count < 2) {
+        return 0.0;
+    }
+    double mean = sum/count;
+    return std::max((sumOfSquares - count*mean*mean)/(count - 1), 0.0);
+}
+
+double RollingStatistics::GetStandardDeviation() const {
+    return sqrt(GetVariance());
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void RollingStatistics::Recompute() {
+    sum = 0.0;
+    sumOfSquares = 0.0;
+    for(int i=0; i < count; ++i) {
+        sum += samples[i];
+        sumOfSquares += samples[i]*samples[i];
+    }
+    pushesSinceRecompute = 0;
+}
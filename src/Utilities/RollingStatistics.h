@@ -0,0 +1,33 @@
+#ifndef ELEKTRON_ESCORT_ROLLING_STATISTICS_H
+#define ELEKTRON_ESCORT_ROLLING_STATISTICS_H
+
+#include <vector>
+#include <algorithm>
+
+
+//Fixed capacity window of the most recent samples with running sum and sum of squares.
+//Push, mean and variance are O(1) and nothing is allocated after Resize.
+class RollingStatistics {
+public:
+    void Resize(int capacity);
+    void Clear();
+    void Push(double sample);
+    int GetCount() const;
+    int GetCapacity() const;
+    bool IsFull() const;
+    double GetMean() const;
+    double GetVariance() const;
+    double GetStandardDeviation() const;
+
+private:
+    std::vector<double> samples;
+    int next = 0;
+    int count = 0;
+    int pushesSinceRecompute = 0;
+    double sum = 0.0;
+    double sumOfSquares = 0.0;
+
+    void Recompute();
+};
+
+#endif //ELEKTRON_ESCORT_ROLLING_STATISTICS_H
@@ -0,0 +1,64 @@
+#ifndef ELEKTRON_ESCORT_SPSC_QUEUE_H
+#define ELEKTRON_ESCORT_SPSC_QUEUE_H
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+
+//Bounded lock-free queue for exactly one producer thread and one consumer thread.
+//Capacity is rounded up to power of two and must be set before either side starts.
+template <typename T>
+class SPSC_Queue {
+public:
+    SPSC_Queue() : mask(0), head(0), tail(0) {}
+
+    void Reserve(size_t capacity) {
+        size_t size = 1;
+        while(size < capacity) {
+            size <<= 1;
+        }
+        buffer.assign(size, T());
+        mask = size - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+
+    //Producer side, returns false when queue is full
+    bool Push(T const& item) {
+        size_t currentHead = head.load(std::memory_order_relaxed);
+        if(currentHead - tail.load(std::memory_order_acquire) >= buffer.size()) {
+            return false;
+        }
+        buffer[currentHead & mask] = item;
+        head.store(currentHead + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer side, returns false when queue is empty
+    bool Pop(T& item) {
+        size_t currentTail = tail.load(std::memory_order_relaxed);
+        if(currentTail == head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = buffer[currentTail & mask];
+        tail.store(currentTail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t Size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    size_t Capacity() const {
+        return buffer.size();
+    }
+
+private:
+    std::vector<T> buffer;
+    size_t mask;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+#endif //ELEKTRON_ESCORT_SPSC_QUEUE_H
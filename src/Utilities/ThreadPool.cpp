@@ -0,0 +1,122 @@
+#include "ThreadPool.h"
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+ThreadPool::~ThreadPool() {
+    Stop();
+}
+
+void ThreadPool::Start(int threads) {
+    Stop();
+    stopping = false;
+    queues.clear();
+    for(int i=0; i < threads; ++i) {
+        queues.push_back(std::unique_ptr<Queue>(new Queue()));
+    }
+    //Queue 0 belongs to calling thread
+    for(int i=1; i < threads; ++i) {
+        workers.push_back(std::thread(&ThreadPool::WorkerLoop, this, i));
+    }
+}
+
+void ThreadPool::Stop() {
+    wakeMutex.lock();
+    stopping = true;
+    wakeMutex.unlock();
+    wake.notify_all();
+    for(int i=0; i < workers.size(); ++i) {
+        workers[i].join();
+    }
+    workers.clear();
+}
+
+int ThreadPool::GetThreadCount() {
+    return workers.size() + 1;
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void ThreadPool::Run(int count, int grain, void (*_invoke)(void*, int, int), void* _context) {
+    invoke = _invoke;
+    context = _context;
+    if(grain < 1) {
+        grain = 1;
+    }
+    int tasks = (count + grain - 1)/grain;
+    pending = tasks;
+    //Consecutive chunks are dealt round robin, so each thread starts with its share
+    for(int i=0; i < tasks; ++i) {
+        Task task;
+        task.begin = i*grain;
+        task.end = std::min(count, task.begin + grain);
+        Queue& queue = *queues[i % queues.size()];
+        queue.mutex.lock();
+        queue.tasks.push_back(task);
+        queue.mutex.unlock();
+    }
+    wakeMutex.lock();
+    ++generation;
+    wakeMutex.unlock();
+    wake.notify_all();
+    Task task;
+    while(PopOrSteal(0, task)) {
+        Execute(task);
+    }
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    done.wait(lock, [this]() { return pending == 0; });
+}
+
+bool ThreadPool::PopOrSteal(int self, Task& task) {
+    Queue& own = *queues[self];
+    own.mutex.lock();
+    if(!own.tasks.empty()) {
+        task = own.tasks.back();
+        own.tasks.pop_back();
+        own.mutex.unlock();
+        return true;
+    }
+    own.mutex.unlock();
+    for(int i=1; i < queues.size(); ++i) {
+        Queue& victim = *queues[(self + i) % queues.size()];
+        victim.mutex.lock();
+        if(!victim.tasks.empty()) {
+            task = victim.tasks.front();
+            victim.tasks.pop_front();
+            victim.mutex.unlock();
+            return true;
+        }
+        victim.mutex.unlock();
+    }
+    return false;
+}
+
+void ThreadPool::Execute(Task const& task) {
+    invoke(context, task.begin, task.end);
+    if(--pending == 0) {
+        wakeMutex.lock();
+        wakeMutex.unlock();
+        done.notify_all();
+    }
+}
+
+void ThreadPool::WorkerLoop(int self) {
+    unsigned long seenGeneration = 0;
+    while(true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [&]() { return stopping || generation != seenGeneration; });
+            if(stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+        Task task;
+        while(PopOrSteal(self, task)) {
+            Execute(task);
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef ELEKTRON_ESCORT_THREAD_POOL_H
+#define ELEKTRON_ESCORT_THREAD_POOL_H
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+
+//Fork-join pool with one task deque per thread. Owner takes tasks from the back of its deque,
+//idle threads steal from the front of others. Calling thread takes part in ParallelFor.
+//Each index is processed exactly once, so results written per index do not depend on scheduling.
+class ThreadPool {
+public:
+    ThreadPool() : generation(0), pending(0), stopping(false), invoke(NULL), context(NULL) {}
+    ~ThreadPool();
+    void Start(int threads);
+    void Stop();
+    int GetThreadCount();
+
+    template<typename Function>
+    void ParallelFor(int count, int grain, Function& function) {
+        if(workers.empty() || count <= grain) {
+            if(count > 0) {
+                function(0, count);
+            }
+            return;
+        }
+        Run(count, grain, &Invoke<Function>, &function);
+    }
+
+private:
+    struct Task {
+        int begin;
+        int end;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned long generation;
+    std::atomic<int> pending;
+    bool stopping;
+    void (*invoke)(void*, int, int);
+    void* context;
+
+    ThreadPool(const ThreadPool &);
+    ThreadPool& operator=(const ThreadPool&);
+    template<typename Function>
+    static void Invoke(void* function, int begin, int end) {
+        (*static_cast<Function*>(function))(begin, end);
+    }
+    void Run(int count, int grain, void (*_invoke)(void*, int, int), void* _context);
+    bool PopOrSteal(int self, Task& task);
+    void Execute(Task const& task);
+    void WorkerLoop(int self);
+};
+
+#endif //ELEKTRON_ESCORT_THREAD_POOL_H
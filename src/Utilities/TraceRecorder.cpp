@@ -0,0 +1,124 @@
+#include "TraceRecorder.h"
+#include <cstring>
+#include <chrono>
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Public
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+bool TraceRecorder::Start(std::string const& fileName, int bufferSize, double _startTime) {
+    if(running) {
+        return true;
+    }
+    file = fopen(fileName.c_str(), "w");
+    if(file == NULL) {
+        return false;
+    }
+    events.Reserve(bufferSize);
+    startTime = _startTime;
+    firstEvent = true;
+    droppedEvents = 0;
+    fprintf(file, "[\n");
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"control\"}},\n", TT_Control);
+    fprintf(file, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"sensor\"}}", TT_Sensor);
+    firstEvent = false;
+    running = true;
+    writerThread = std::thread(&TraceRecorder::WriterThreadLoop, this);
+    return true;
+}
+
+void TraceRecorder::Stop() {
+    if(!running) {
+        return;
+    }
+    running = false;
+    if(writerThread.joinable()) {
+        writerThread.join();
+    }
+    Flush();
+    fprintf(file, "\n]\n");
+    fclose(file);
+    file = NULL;
+}
+
+bool TraceRecorder::IsRunning() {
+    return running;
+}
+
+unsigned long TraceRecorder::GetDroppedEventsCount() {
+    return droppedEvents;
+}
+
+void TraceRecorder::Span(const char* name, const char* category, double start, double end, int threadId) {
+    TraceEvent event;
+    event.category = category;
+    event.phase = 'X';
+    event.threadId = threadId;
+    event.timestamp = start;
+    event.duration = end - start;
+    event.argument = -1;
+    Push(event, name);
+}
+
+void TraceRecorder::Instant(const char* name, const char* category, double time, int threadId, long argument) {
+    TraceEvent event;
+    event.category = category;
+    event.phase = 'i';
+    event.threadId = threadId;
+    event.timestamp = time;
+    event.duration = 0.0;
+    event.argument = argument;
+    Push(event, name);
+}
+
+
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+//Private
+///////////////////////////////////////////////////////////////////////////////////////////////////////////
+void TraceRecorder::Push(TraceEvent& event, const char* name) {
+    if(!running) {
+        return;
+    }
+    strncpy(event.name, name, TRACE_NAME_LENGTH - 1);
+    event.name[TRACE_NAME_LENGTH - 1] = '\0';
+    if(!events.Push(event)) {
+        ++droppedEvents;
+    }
+}
+
+void TraceRecorder::WriterThreadLoop() {
+    while(running) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRACE_FLUSH_PERIOD_MS));
+        Flush();
+    }
+}
+
+void TraceRecorder::Flush() {
+    TraceEvent event;
+    bool written = false;
+    while(events.Pop(event)) {
+        Write(event);
+        written = true;
+    }
+    if(written) {
+        fflush(file);
+    }
+}
+
+void TraceRecorder::Write(TraceEvent const& event) {
+    //Timestamps and durations in microseconds as expected by trace viewers
+    fprintf(file, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%.1f",
+            firstEvent ? "" : ",\n", event.name, event.category, event.phase, event.threadId,
+            (event.timestamp - startTime)*1000000.0);
+    if(event.phase == 'X') {
+        fprintf(file, ",\"dur\":%.1f", event.duration*1000000.0);
+    }
+    else if(event.phase == 'i') {
+        fprintf(file, ",\"s\":\"t\"");
+    }
+    if(event.argument >= 0) {
+        fprintf(file, ",\"args\":{\"user\":%ld}", event.argument);
+    }
+    fprintf(file, "}");
+    firstEvent = false;
+}
@@ -0,0 +1,55 @@
+#ifndef ELEKTRON_ESCORT_TRACE_RECORDER_H
+#define ELEKTRON_ESCORT_TRACE_RECORDER_H
+
+#define TRACE_NAME_LENGTH 48
+#define TRACE_FLUSH_PERIOD_MS 100
+
+#include <string>
+#include <thread>
+#include <atomic>
+#include <cstdio>
+#include "SPSC_Queue.h"
+
+
+enum TraceThreads {
+    TT_Control = 1, TT_Sensor = 2
+};
+
+//Chrome trace (JSON array format) writer. Events are recorded by one thread into
+//preallocated ring and written to file by background thread, full ring drops events.
+class TraceRecorder {
+public:
+    TraceRecorder() : running(false), droppedEvents(0) {}
+    bool Start(std::string const& fileName, int bufferSize, double startTime);
+    void Stop();
+    bool IsRunning();
+    unsigned long GetDroppedEventsCount();
+    void Span(const char* name, const char* category, double start, double end, int threadId);
+    void Instant(const char* name, const char* category, double time, int threadId, long argument = -1);
+
+private:
+    struct TraceEvent {
+        char name[TRACE_NAME_LENGTH];
+        const char* category;
+        char phase;
+        int threadId;
+        double timestamp;
+        double duration;
+        long argument;
+    };
+
+    FILE* file = NULL;
+    double startTime = 0.0;
+    bool firstEvent = true;
+    SPSC_Queue<TraceEvent> events;
+    std::thread writerThread;
+    std::atomic<bool> running;
+    std::atomic<unsigned long> droppedEvents;
+
+    void Push(TraceEvent& event, const char* name);
+    void WriterThreadLoop();
+    void Flush();
+    void Write(TraceEvent const& event);
+};
+
+#endif //ELEKTRON_ESCORT_TRACE_RECORDER_H
@@ -0,0 +1,52 @@
+#ifndef ELEKTRON_ESCORT_TRIPLE_BUFFER_H
+#define ELEKTRON_ESCORT_TRIPLE_BUFFER_H
+
+#include <atomic>
+
+
+//Lock-free triple buffer for exactly one writer thread and one reader thread.
+//Writer fills back slot and exchanges it with middle one, reader exchanges middle slot with its front one
+//only when middle holds data it has not seen, so neither side waits and slot returned by Read
+//stays untouched until the reader calls Read again.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : back(0), middle(1), front(2) {}
+
+    //Fills all slots before either side starts
+    void Reset(T const& value) {
+        for(int i=0; i < 3; ++i) {
+            slots[i] = value;
+        }
+        back = 0;
+        middle.store(1, std::memory_order_relaxed);
+        front = 2;
+    }
+
+    //Writer side, slot to be filled before Publish
+    T& GetBack() {
+        return slots[back];
+    }
+
+    void Publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    //Reader side, latest published slot
+    T const& Read() {
+        if(middle.load(std::memory_order_relaxed) & FRESH) {
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+        return slots[front];
+    }
+
+private:
+    static const int INDEX_MASK = 3;
+    static const int FRESH = 4;
+    T slots[3];
+    int back;
+    alignas(64) std::atomic<int> middle;
+    alignas(64) int front;
+};
+
+#endif //ELEKTRON_ESCORT_TRIPLE_BUFFER_H
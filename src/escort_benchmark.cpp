@@ -0,0 +1,233 @@
+#define DEFAULT_BENCHMARK_LOG_LEVEL Info
+#define DEFAULT_BENCHMARK_FRAMES 3000
+#define DEFAULT_BENCHMARK_WARMUP_FRAMES 300
+#define BENCHMARK_FRAME_TIME (1.0/30.0)
+
+#include <map>
+#include <ros/ros.h>
+#include <ros/package.h>
+#include "Common.h"
+#include "Modules/SensorsModule.h"
+#include "Modules/TrackerModule.h"
+#include "Modules/IdentificationModule.h"
+#include "Modules/TaskModule.h"
+#include "Modules/MobilityModule.h"
+#include "Modules/DataStorage.h"
+#include "Modules/ReplayModule.h"
+#include "Modules/DiagnosticsModule.h"
+#include "Modules/SkeletonSources/Synthetic_Source.h"
+
+
+//Runs whole control loop on synthetic source as fast as possible and reports time per frame of every stage.
+//Configuration is taken from private params like in escort_main, source and replay speed are forced, e.g.
+//rosrun elektron_escort escort_benchmark _staticMethodPipeline:=true _syntheticUsers:=30 _maxUsers:=50
+//Tracker is scored against ground truth of synthetic source, track swap is track moving to other person,
+//for swaps at crossings run it with _syntheticScenario:=crossing
+
+enum BenchmarkStages {
+    BS_Sensors, BS_Tracker, BS_Identification, BS_Task, BS_Mobility, BS_DataStorage, BS_NUMBER_OF_STAGES
+};
+
+static const char* benchmarkStageNames[BS_NUMBER_OF_STAGES] = {
+    "sensors", "tracker", "identification", "task", "mobility", "data_storage"
+};
+
+ros::NodeHandle* nodeHandlePublic;
+ros::NodeHandle* nodeHandlePrivate;
+LogLevels logLevel;
+int frames;
+int warmupFrames;
+double stageTimes[BS_NUMBER_OF_STAGES];
+double loopTime;
+Synthetic_Source* synthetic;
+std::map<unsigned long, int> trackPersons;
+unsigned long trackSwaps;
+unsigned long measuredCrossings;
+unsigned long measuredIdSwaps;
+
+
+bool Initialization() {
+    nodeHandlePublic = new ros::NodeHandle();
+    nodeHandlePrivate = new ros::NodeHandle("~");
+    int _logLevel;
+    if(!nodeHandlePrivate->getParam("benchmarkLogLevel", _logLevel)) {
+        logLevel = DEFAULT_BENCHMARK_LOG_LEVEL;
+    }
+    else {
+        switch (_logLevel) {
+            case 0:
+                logLevel = Debug;
+                break;
+            case 1:
+                logLevel = Info;
+                break;
+            case 2:
+                logLevel = Warn;
+                break;
+            case 3:
+                logLevel = Error;
+                break;
+            default:
+                ROS_WARN("Benchmark: Requested invalid log level, using default");
+                logLevel = DEFAULT_BENCHMARK_LOG_LEVEL;
+                break;
+        }
+    }
+    if(!nodeHandlePrivate->getParam("benchmarkFrames", frames)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("Benchmark: Value of benchmarkFrames not found, using default: %d", DEFAULT_BENCHMARK_FRAMES);
+        }
+        frames = DEFAULT_BENCHMARK_FRAMES;
+    }
+    if(!nodeHandlePrivate->getParam("benchmarkWarmupFrames", warmupFrames)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("Benchmark: Value of benchmarkWarmupFrames not found, using default: %d", DEFAULT_BENCHMARK_WARMUP_FRAMES);
+        }
+        warmupFrames = DEFAULT_BENCHMARK_WARMUP_FRAMES;
+    }
+    if(frames < 1 || warmupFrames < 0) {
+        if(logLevel <= Error) {
+            ROS_ERROR("Benchmark: Requested invalid number of frames: %d, warmup: %d", frames, warmupFrames);
+        }
+        return false;
+    }
+    //Measured frames must not wait for sensor or loop rate, and must not end early
+    nodeHandlePrivate->setParam("sensorSource", std::string("synthetic"));
+    nodeHandlePrivate->setParam("replayFile", std::string(""));
+    nodeHandlePrivate->setParam("replayAsFastAsPossible", true);
+    nodeHandlePrivate->setParam("syntheticDuration", 0.0);
+    if(!DiagnosticsModule::GetInstance().Initialize(nodeHandlePublic, nodeHandlePrivate, BENCHMARK_FRAME_TIME) ||
+       !ReplayModule::GetInstance().Initialize(nodeHandlePrivate) ||
+       !DataStorage::GetInstance().Initialize(nodeHandlePrivate) ||
+       !MobilityModule::GetInstance().Initialize(nodeHandlePublic, nodeHandlePrivate) ||
+       !SensorsModule::GetInstance().Initialize(nodeHandlePrivate) ||
+       !TrackerModule::GetInstance().Initialize(nodeHandlePrivate) ||
+       !IdentificationModule::GetInstance().Initialize(nodeHandlePrivate) ||
+       !TaskModule::GetInstance().Initialize(nodeHandlePrivate)) {
+        if(logLevel <= Error) {
+            ROS_ERROR("Benchmark: Failed to initialize modules");
+        }
+        return false;
+    }
+    for(int i=0; i < BS_NUMBER_OF_STAGES; ++i) {
+        stageTimes[i] = 0.0;
+    }
+    loopTime = 0.0;
+    synthetic = (Synthetic_Source*)SensorsModule::GetInstance().GetSource();
+    trackPersons.clear();
+    trackSwaps = 0;
+    measuredCrossings = 0;
+    measuredIdSwaps = 0;
+    return true;
+}
+
+//Capture runs on this thread, so state of source is the one of current frame
+void ScoreTracks(bool measured) {
+    TrackerModule& tracker = TrackerModule::GetInstance();
+    for(auto it = trackPersons.begin(); it != trackPersons.end();) {
+        if(tracker.IsTrackAlive(it->first)) {
+            ++it;
+        }
+        else {
+            it = trackPersons.erase(it);
+        }
+    }
+    std::vector<XnUserID> const& users = SensorsModule::GetInstance().GetFrame().users;
+    for(int i=0; i < users.size(); ++i) {
+        unsigned long trackId = tracker.GetTrackId(users[i]);
+        int person = synthetic->GetPersonOfUser(users[i]);
+        if(trackId == NO_TRACK || person < 0) {
+            continue;
+        }
+        auto it = trackPersons.find(trackId);
+        if(it == trackPersons.end()) {
+            trackPersons[trackId] = person;
+        }
+        else if(it->second != person) {
+            if(measured) {
+                ++trackSwaps;
+            }
+            it->second = person;
+        }
+    }
+}
+
+//Same order as escort_main, every stage is timed on its own
+void Update(bool measured) {
+    double times[BS_NUMBER_OF_STAGES + 1];
+    DiagnosticsModule& diagnostics = DiagnosticsModule::GetInstance();
+    diagnostics.BeginTick();
+    times[BS_Sensors] = DiagnosticsModule::Now();
+    SensorsModule::GetInstance().Update();
+    times[BS_Tracker] = DiagnosticsModule::Now();
+    TrackerModule::GetInstance().Update();
+    double timeElapsed = ReplayModule::GetInstance().GetFrameTimeElapsed(BENCHMARK_FRAME_TIME);
+    times[BS_Identification] = DiagnosticsModule::Now();
+    IdentificationModule::GetInstance().Update();
+    times[BS_Task] = DiagnosticsModule::Now();
+    TaskModule::GetInstance().Update(timeElapsed);
+    times[BS_Mobility] = DiagnosticsModule::Now();
+    MobilityModule::GetInstance().Update();
+    times[BS_DataStorage] = DiagnosticsModule::Now();
+    DataStorage::GetInstance().Update(timeElapsed);
+    times[BS_NUMBER_OF_STAGES] = DiagnosticsModule::Now();
+    ReplayModule::GetInstance().Update();
+    diagnostics.EndTick();
+    ScoreTracks(measured);
+    if(measured) {
+        for(int i=0; i < BS_NUMBER_OF_STAGES; ++i) {
+            stageTimes[i] += times[i + 1] - times[i];
+        }
+        loopTime += times[BS_NUMBER_OF_STAGES] - times[BS_Sensors];
+    }
+}
+
+void Finish() {
+    if(logLevel <= Info) {
+        bool staticPipeline = DEFAULT_STATIC_METHOD_PIPELINE;
+        int threads = DEFAULT_IDENTIFICATION_THREADS;
+        int users = DEFAULT_SYNTHETIC_USERS;
+        nodeHandlePrivate->getParam("staticMethodPipeline", staticPipeline);
+        nodeHandlePrivate->getParam("identificationThreads", threads);
+        nodeHandlePrivate->getParam("syntheticUsers", users);
+        ROS_INFO("Benchmark: %d frames, %s pipeline, %d identification threads, %d synthetic users", frames,
+                 staticPipeline ? "static" : "virtual", threads, users);
+        ROS_INFO("Benchmark: loop %.3f us per frame", 1e6*loopTime/frames);
+        for(int i=0; i < BS_NUMBER_OF_STAGES; ++i) {
+            ROS_INFO("Benchmark: %s %.3f us per frame", benchmarkStageNames[i], 1e6*stageTimes[i]/frames);
+        }
+        ROS_INFO("Benchmark: crossings: %lu, sensor id swaps: %lu, track swaps: %lu", measuredCrossings, measuredIdSwaps, trackSwaps);
+        if(measuredCrossings > 0) {
+            ROS_INFO("Benchmark: sensor id swap rate %.3f, track swap rate %.3f per crossing",
+                     (double)measuredIdSwaps/measuredCrossings, (double)trackSwaps/measuredCrossings);
+        }
+        if(measuredIdSwaps > 0) {
+            ROS_INFO("Benchmark: track swaps per sensor id swap %.3f", (double)trackSwaps/measuredIdSwaps);
+        }
+    }
+    delete nodeHandlePublic;
+    delete nodeHandlePrivate;
+    SensorsModule::GetInstance().Finish();
+    TrackerModule::GetInstance().Finish();
+    IdentificationModule::GetInstance().Finish();
+    ReplayModule::GetInstance().Finish();
+    DiagnosticsModule::GetInstance().Finish();
+}
+
+int main(int argc, char **argv) {
+    ros::init(argc, argv, "elektron_escort_benchmark");
+    if(!Initialization()) {
+        return 1;
+    }
+    for(int i=0; i < warmupFrames + frames && ros::ok(); ++i) {
+        if(i == warmupFrames) {
+            measuredCrossings = synthetic->GetCrossingsCount();
+            measuredIdSwaps = synthetic->GetIdSwapsCount();
+        }
+        Update(i >= warmupFrames);
+    }
+    measuredCrossings = synthetic->GetCrossingsCount() - measuredCrossings;
+    measuredIdSwaps = synthetic->GetIdSwapsCount() - measuredIdSwaps;
+    Finish();
+    return 0;
+}
@@ -1,14 +1,18 @@
 #define DEFAULT_ESCORT_MAIN_LOG_LEVEL Info
 #define DEFAULT_MAIN_LOOP_RATE 30.0
+#define DEFAULT_PIPELINED_EXECUTION false
 
 #include <ros/ros.h>
 #include <ros/package.h>
 #include "Common.h"
 #include "Modules/SensorsModule.h"
+#include "Modules/TrackerModule.h"
 #include "Modules/IdentificationModule.h"
 #include "Modules/TaskModule.h"
 #include "Modules/MobilityModule.h"
 #include "Modules/DataStorage.h"
+#include "Modules/ReplayModule.h"
+#include "Modules/DiagnosticsModule.h"
 
 
 ros::NodeHandle* nodeHandlePublic;
@@ -16,6 +20,7 @@ ros::NodeHandle* nodeHandlePrivate;
 LogLevels logLevel;
 double mainLoopRate;
 double mainLoopTime;
+bool pipelinedExecution;
 
 
 bool Initialization() {
@@ -59,7 +64,35 @@ bool Initialization() {
         mainLoopRate = DEFAULT_MAIN_LOOP_RATE;
     }
     mainLoopTime = 1/mainLoopRate;
+    if(!nodeHandlePrivate->getParam("pipelinedExecution", pipelinedExecution)) {
+        if(logLevel <= Warn) {
+            ROS_WARN("EscortMain: Value of pipelinedExecution not found, using default: %d", DEFAULT_PIPELINED_EXECUTION);
+        }
+        pipelinedExecution = DEFAULT_PIPELINED_EXECUTION;
+    }
     //Modules initialization
+    if(DiagnosticsModule::GetInstance().Initialize(nodeHandlePublic, nodeHandlePrivate, mainLoopTime)) {
+        if(logLevel <= Debug) {
+            ROS_DEBUG("EscortMain: Diagnostics module initialized successfully");
+        }
+    }
+    else {
+        if(logLevel <= Error) {
+            ROS_ERROR("EscortMain: Failed to initialize diagnostics module");
+        }
+        return false;
+    }
+    if(ReplayModule::GetInstance().Initialize(nodeHandlePrivate)) {
+        if(logLevel <= Debug) {
+            ROS_DEBUG("EscortMain: Replay module initialized successfully");
+        }
+    }
+    else {
+        if(logLevel <= Error) {
+            ROS_ERROR("EscortMain: Failed to initialize replay module");
+        }
+        return false;
+    }
     if(DataStorage::GetInstance().Initialize(nodeHandlePrivate)) {
         if(logLevel <= Debug) {
             ROS_DEBUG("EscortMain: Data storage initialized successfully");
@@ -93,6 +126,17 @@ bool Initialization() {
         }
         return false;
     }
+    if(TrackerModule::GetInstance().Initialize(nodeHandlePrivate)) {
+        if(logLevel <= Debug) {
+            ROS_DEBUG("EscortMain: Tracker module initialized successfully");
+        }
+    }
+    else {
+        if(logLevel <= Error) {
+            ROS_ERROR("EscortMain: Failed to initialize tracker module");
+        }
+        return false;
+    }
     if(IdentificationModule::GetInstance().Initialize(nodeHandlePrivate)) {
         if(logLevel <= Debug) {
             ROS_DEBUG("EscortMain: Identification module initialized successfully");
@@ -115,6 +159,22 @@ bool Initialization() {
         }
         return false;
     }
+    if(!ReplayModule::GetInstance().StartSkeletonLog()) {
+        if(logLevel <= Error) {
+            ROS_ERROR("EscortMain: Failed to start skeleton log");
+        }
+        return false;
+    }
+    if(pipelinedExecution) {
+        if(!SensorsModule::GetInstance().IsLive()) {
+            if(logLevel <= Warn) {
+                ROS_WARN("EscortMain: Pipelined execution disabled for non-live source to keep results deterministic");
+            }
+        }
+        else {
+            SensorsModule::GetInstance().StartCaptureThread();
+        }
+    }
     if(logLevel <= Info) {
         ROS_INFO("EscortMain: Initialization complete, starting program");
     }
@@ -122,27 +182,54 @@ bool Initialization() {
 }
 
 void Update() {
+    DiagnosticsModule& diagnostics = DiagnosticsModule::GetInstance();
+    diagnostics.BeginTick();
+    diagnostics.BeginStage(DS_Sensors);
     SensorsModule::GetInstance().Update();
+    diagnostics.EndStage(DS_Sensors);
+    diagnostics.BeginStage(DS_Tracker);
+    TrackerModule::GetInstance().Update();
+    diagnostics.EndStage(DS_Tracker);
+    double timeElapsed = ReplayModule::GetInstance().GetFrameTimeElapsed(mainLoopTime);
+    diagnostics.BeginStage(DS_Identification);
     IdentificationModule::GetInstance().Update();
-    TaskModule::GetInstance().Update(mainLoopTime);
+    diagnostics.EndStage(DS_Identification);
+    diagnostics.BeginStage(DS_Task);
+    TaskModule::GetInstance().Update(timeElapsed);
+    diagnostics.EndStage(DS_Task);
+    diagnostics.BeginStage(DS_Mobility);
     MobilityModule::GetInstance().Update();
-    DataStorage::GetInstance().Update(mainLoopTime);
+    diagnostics.EndStage(DS_Mobility);
+    diagnostics.BeginStage(DS_DataStorage);
+    DataStorage::GetInstance().Update(timeElapsed);
+    diagnostics.EndStage(DS_DataStorage);
+    ReplayModule::GetInstance().Update();
+    diagnostics.EndTick();
 }
 
 void Finish() {
 	delete nodeHandlePublic;
 	delete nodeHandlePrivate;
     SensorsModule::GetInstance().Finish();
+    TrackerModule::GetInstance().Finish();
     IdentificationModule::GetInstance().Finish();
+    ReplayModule::GetInstance().Finish();
+    DiagnosticsModule::GetInstance().Finish();
 }
 
 int main(int argc, char **argv) {
 	ros::init(argc, argv, "elektron_escort");
 	if(Initialization()) {
 		ros::Rate mainLoopRate(mainLoopRate);
-		while (ros::ok()) {
+		while (ros::ok() && !SensorsModule::GetInstance().IsEndOfRecording()) {
             Update();
-			mainLoopRate.sleep();
+            //With capture thread new frame is processed as soon as it arrives, loop period only bounds the wait
+            if(SensorsModule::GetInstance().IsCaptureThreadRunning()) {
+                SensorsModule::GetInstance().WaitForFrame(mainLoopTime);
+            }
+            else if(!ReplayModule::GetInstance().IsAsFastAsPossible()) {
+                mainLoopRate.sleep();
+            }
 		}
 	}
     if(logLevel <= Info) {